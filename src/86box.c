@@ -137,6 +137,7 @@ int video_fps = RENDER_FPS; /* (O) render speed in fps */
 #endif
 int settings_only     = 0; /* (O) show only the settings dialog */
 int confirm_exit_cmdl = 1; /* (O) do not ask for confirmation on quit if set to 0 */
+int turbo_mode        = 0; /* (O) run as fast as the host allows */
 #ifdef _WIN32
 uint64_t unique_id   = 0;
 uint64_t source_hwnd = 0;
@@ -194,9 +195,27 @@ uint32_t mem_size                               = 0;              /* (C) memory
                                                                          system board)*/
 uint32_t isa_mem_size                           = 0;              /* (C) memory size (ISA Memory Cards) */
 int      cpu_use_dynarec                        = 0;              /* (C) cpu uses/needs Dyna */
+int      cpu_dynarec_hint_cache                 = 0;              /* (C) remember which dynarec blocks
+                                                                         were recompiled across runs */
+int      cpu_dynarec_threshold                  = 1;              /* (C) interpreted runs before a block
+                                                                         is recompiled */
+int      cpu_dynarec_hot_threshold              = 0;              /* (C) runs before a block is recompiled
+                                                                         as hot, 0 = never */
+int      cpu_808x_fast                          = 0;              /* (C) 808x uses batched cycle
+                                                                         accounting */
+int      cpu_tlb_size                           = 0;              /* (C) software TLB entries,
+                                                                         0 = default */
+int      mem_ksm                                = 0;              /* (C) let the host merge identical
+                                                                         guest RAM pages */
+int      rivatimer_emulated                     = 0;              /* (C) rivatimers run in emulated
+                                                                         time */
+int      cpu_hlt_skip                           = 1;              /* (C) halted cpu skips ahead to
+                                                                         the next timer */
 int      cpu                                    = 0;              /* (C) cpu type */
 int      fpu_type                               = 0;              /* (C) fpu type */
 int      fpu_softfloat                          = 0;              /* (C) fpu uses softfloat */
+int      fpu_softfloat_fast                     = 0;              /* (C) softfloat uses the host FPU
+                                                                         when the result is exact */
 int      time_sync                              = 0;              /* (C) enable time sync */
 int      confirm_reset                          = 1;              /* (C) enable reset confirmation */
 int      confirm_exit                           = 1;              /* (C) enable exit confirmation */
@@ -261,6 +280,14 @@ extern int writelnum;
 int fps;
 int framecount;
 
+/* Main loop time slicing. */
+int             pc_slice_us      = PC_SLICE_US;
+uint64_t        pc_slice_host_us = 0;
+static int      slice_input_us   = 0;
+static uint32_t slice_kbd_events = 0;
+static int      slice_mouse_b    = 0;
+static uint64_t framecount_us    = 0;
+
 extern int CPUID;
 extern int output;
 int        atfullspeed;
@@ -621,6 +648,8 @@ pc_show_usage(char *s)
 #endif
             "-T or --testmode\t\t- test mode: execute the test mode entry\n"
             "\t\t\t\t   point on init/hard reset\n"
+            "-U or --turbo\t\t\t- run as fast as the host allows, without\n"
+            "\t\t\t\t   sound and with a capped display rate\n"
             "-V or --vmname name\t\t- overrides the name of the running VM\n"
             "-W or --nohook\t\t- disables keyboard hook\n"
             "\t\t\t\t   (compatibility-only outside Windows)\n"
@@ -798,6 +827,8 @@ usage:
 #endif
         } else if (!strcasecmp(argv[c], "--testmode") || !strcasecmp(argv[c], "-T")) {
             test_mode = 1;
+        } else if (!strcasecmp(argv[c], "--turbo") || !strcasecmp(argv[c], "-U")) {
+            turbo_mode = 1;
         } else if (!strcasecmp(argv[c], "--noconfirm") || !strcasecmp(argv[c], "-N")) {
             confirm_exit_cmdl = 0;
         } else if (!strcasecmp(argv[c], "--missing") || !strcasecmp(argv[c], "-M")) {
@@ -1352,6 +1383,10 @@ pc_reset_hard_close(void)
     nvr_save();
     nvr_close();
 
+#if defined(USE_DYNAREC) && defined(USE_NEW_DYNAREC)
+    codegen_hint_cache_save();
+#endif
+
     mouse_close();
 
     device_close_all();
@@ -1516,6 +1551,9 @@ pc_reset_hard_init(void)
 
     /* Reset the CPU module. */
     resetx86();
+#if defined(USE_DYNAREC) && defined(USE_NEW_DYNAREC)
+    codegen_hint_cache_load();
+#endif
     dma_reset();
     pci_pic_reset();
     cpu_cache_int_enabled = cpu_cache_ext_enabled = 0;
@@ -1595,6 +1633,9 @@ pc_close(UNUSED(thread_t *ptr))
     is_quit = 1;
 
     nvr_save();
+#if defined(USE_DYNAREC) && defined(USE_NEW_DYNAREC)
+    codegen_hint_cache_save();
+#endif
 
     config_save();
 
@@ -1659,6 +1700,35 @@ ack_pause(void)
     }
 }
 
+/* Run the CPU for slice_us microseconds. While any rivatimers (the guest-CPU
+   independent timers used by devices with their own clock) with a period of
+   at least RIVATIMER_SLICE_MIN_US are running, the slice is split at their
+   deadlines so they get serviced between the pieces. Everything else is
+   serviced once at the end of the slice. */
+static void
+pc_run_slice(int slice_us)
+{
+    double next;
+    int    step;
+
+    while (slice_us > 0) {
+        step = slice_us;
+        next = rivatimer_next_deadline();
+        if (next >= 0.0) {
+            if (next < RIVATIMER_SLICE_MIN_US)
+                next = RIVATIMER_SLICE_MIN_US;
+            if (next < step)
+                step = (int) next;
+        }
+
+        cpu_exec((int32_t) (((int64_t) cpu_s->rspeed * step) / 1000000));
+
+        rivatimer_advance(step);
+        rivatimer_update_all();
+        slice_us -= step;
+    }
+}
+
 void
 pc_run(void)
 {
@@ -1672,12 +1742,9 @@ pc_run(void)
         pc_reset_hard_init();
     }
 
-    /* Update the guest-CPU independent timer for devices with independent clock speed */
-    rivatimer_update_all();
-
     /* Run a block of code. */
     startblit();
-    cpu_exec((int32_t) cpu_s->rspeed / 100);
+    pc_run_slice(pc_slice_us);
     ack_pause();
 #ifdef USE_GDBSTUB /* avoid a KBC FIFO overflow when CPU emulation is stalled */
     if (gdbstub_step == GDBSTUB_EXEC) {
@@ -1690,8 +1757,10 @@ pc_run(void)
     joystick_process();
     endblit();
 
-    /* Done with this frame, update statistics. */
-    framecount++;
+    /* Done with this frame, update statistics. The speed is
+       reported as the number of 10 ms periods run per second. */
+    framecount_us += pc_slice_us;
+    framecount = (int) (framecount_us / 10000);
     if (++framecountx >= 100) {
         framecountx = 0;
         frames      = 0;
@@ -1710,12 +1779,55 @@ pc_run(void)
     }
 }
 
+/*
+ * Pick the length of the next slice of the main loop. Longer slices
+ * mean fewer wakeups and less overhead per emulated second, shorter
+ * ones mean that input reaches the guest sooner. So use short slices
+ * for a while after keyboard or mouse input, the old 10 ms slices
+ * while sound is playing, and long slices otherwise or in turbo mode.
+ * The slice length must not leak into the emulated timer granularity;
+ * exec386_dynarec() runs timers every 5 us of CPU time regardless.
+ */
+int
+pc_slice_next(void)
+{
+    uint32_t kbd_events = keyboard_input_events;
+    int      mouse_b    = mouse_get_buttons_ex();
+
+    if ((kbd_events != slice_kbd_events) || (mouse_b != slice_mouse_b) || mouse_moved())
+        slice_input_us = PC_INPUT_HOLD_US;
+
+    slice_kbd_events = kbd_events;
+    slice_mouse_b    = mouse_b;
+
+    if (turbo_mode) {
+        /* Nothing is paced to real time, so only the overhead matters. */
+        pc_slice_us = PC_SLICE_MAX_US;
+    } else if (slice_input_us > 0) {
+        pc_slice_us = PC_SLICE_MIN_US;
+        slice_input_us -= pc_slice_us;
+    } else if (!sound_muted)
+        pc_slice_us = PC_SLICE_US;
+    else
+        pc_slice_us = PC_SLICE_MAX_US;
+
+    return pc_slice_us;
+}
+
+/* Record how much host time the last slice took to run. */
+void
+pc_slice_done(uint64_t host_us)
+{
+    pc_slice_host_us = host_us;
+}
+
 /* Handler for the 1-second timer to refresh the window title. */
 void
 pc_onesec(void)
 {
-    fps        = framecount;
-    framecount = 0;
+    fps           = framecount;
+    framecount    = 0;
+    framecount_us = 0;
 
     title_update = 1;
 }
@@ -16,6 +16,8 @@ void (*codegen_timing_block_start)(void);
 void (*codegen_timing_block_end)(void);
 int (*codegen_timing_jump_cycles)(void);
 
+static void (*codegen_timing_model_init)(void);
+
 void
 codegen_timing_set(codegen_timing_t *timing)
 {
@@ -25,6 +27,17 @@ codegen_timing_set(codegen_timing_t *timing)
     codegen_timing_block_start = timing->block_start;
     codegen_timing_block_end   = timing->block_end;
     codegen_timing_jump_cycles = timing->jump_cycles;
+    codegen_timing_model_init  = timing->init;
+}
+
+/*Builds the timing lookup tables. Called at the end of cpu_set(), as the
+  tables depend on the timing_* variables set for the new CPU*/
+void
+codegen_timing_init(void)
+{
+    codegen_timing_common_init();
+    if (codegen_timing_model_init)
+        codegen_timing_model_init();
 }
 
 int codegen_in_recompile;
@@ -304,6 +304,7 @@ typedef struct codegen_timing_t {
     void (*block_start)(void);
     void (*block_end)(void);
     int (*jump_cycles)(void);
+    void (*init)(void);
 } codegen_timing_t;
 
 extern codegen_timing_t codegen_timing_pentium;
@@ -317,6 +318,8 @@ extern codegen_timing_t codegen_timing_k7;
 extern codegen_timing_t codegen_timing_p6;
 
 void codegen_timing_set(codegen_timing_t *timing);
+void codegen_timing_init(void);
+void codegen_timing_common_init(void);
 
 extern int block_current;
 extern int block_pos;
@@ -28,6 +28,7 @@
 
 int      codegen_flat_ds;
 int      codegen_flat_ss;
+int      codegen_default_mxcsr;
 int      codegen_flags_changed = 0;
 int      codegen_fpu_entered   = 0;
 int      codegen_fpu_loaded_iq[8];
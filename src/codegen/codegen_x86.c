@@ -67,6 +67,7 @@
 
 int      codegen_flat_ds;
 int      codegen_flat_ss;
+int      codegen_default_mxcsr;
 int      mmx_ebx_ecx_loaded;
 int      codegen_flags_changed = 0;
 int      codegen_fpu_entered   = 0;
@@ -65,6 +65,8 @@ void (*codegen_timing_block_start)(void);
 void (*codegen_timing_block_end)(void);
 int (*codegen_timing_jump_cycles)(void);
 
+static void (*codegen_timing_model_init)(void);
+
 void
 codegen_timing_set(codegen_timing_t *timing)
 {
@@ -74,6 +76,17 @@ codegen_timing_set(codegen_timing_t *timing)
     codegen_timing_block_start = timing->block_start;
     codegen_timing_block_end   = timing->block_end;
     codegen_timing_jump_cycles = timing->jump_cycles;
+    codegen_timing_model_init  = timing->init;
+}
+
+/*Builds the timing lookup tables. Called at the end of cpu_set(), as the
+  tables depend on the timing_* variables set for the new CPU*/
+void
+codegen_timing_init(void)
+{
+    codegen_timing_common_init();
+    if (codegen_timing_model_init)
+        codegen_timing_model_init();
 }
 
 int codegen_in_recompile;
@@ -380,6 +393,26 @@ static uint8_t opcode_0f_modrm[256] = {
 };
 // clang-format on
 
+/*Returns whether an opcode may be recompiled for the configured CPU and FPU.
+  The 286 only has a handful of 0f opcodes, none of which are recompiled, and
+  the 287 lacks FUCOM, FUCOMP and FUCOMPP. These are left to the interpreter,
+  which raises #UD*/
+static int
+codegen_recomp_valid(const RecompOpFn *recomp_op_table, uint8_t opcode)
+{
+    if (!is386 && ((recomp_op_table == recomp_opcodes_0f) || (recomp_op_table == recomp_opcodes_0f_no_mmx)))
+        return 0;
+
+    if (fpu_type == FPU_287) {
+        if ((recomp_op_table == recomp_opcodes_da) && (opcode == 0xe9))
+            return 0;
+        if ((recomp_op_table == recomp_opcodes_dd) && ((opcode & 0xf0) == 0xe0))
+            return 0;
+    }
+
+    return 1;
+}
+
 void
 codegen_generate_call(uint8_t opcode, OpFn op, uint32_t fetchdat, uint32_t new_pc, uint32_t old_pc)
 {
@@ -391,7 +424,7 @@ codegen_generate_call(uint8_t opcode, OpFn op, uint32_t fetchdat, uint32_t new_p
     int          opcode_shift       = 0;
     int          opcode_mask        = 0x3ff;
     uint32_t     recomp_opcode_mask = 0x1ff;
-    uint32_t     op_32              = use32;
+    uint32_t     op_32              = is386 ? use32 : 0;
     int          over               = 0;
     int          test_modrm         = 1;
     int          pc_off             = 0;
@@ -406,6 +439,10 @@ codegen_generate_call(uint8_t opcode, OpFn op, uint32_t fetchdat, uint32_t new_p
     codegen_timing_start();
 
     while (!over) {
+        /*The 286 has no FS/GS or operand and address size prefixes*/
+        if (!is386 && ((opcode & 0xfc) == 0x64))
+            goto generate_call;
+
         switch (opcode) {
             case 0x0f:
 #ifdef DEBUG_EXTRA
@@ -628,7 +665,7 @@ generate_call:
             codegen_accumulate(ir, ACCREG_cycles, jump_cycles);
     }
 
-    if (op_table == x86_dynarec_opcodes_0f && opcode == 0x0f) {
+    if (is386 && op_table == x86_dynarec_opcodes_0f && opcode == 0x0f) {
         /*3DNow opcodes are stored after ModR/M, SIB and any offset*/
         uint8_t  modrm     = fetchdat & 0xff;
         uint8_t  sib       = (fetchdat >> 8) & 0xff;
@@ -685,7 +722,7 @@ generate_call:
         goto codegen_skip;
 #endif
 
-    if (recomp_op_table && recomp_op_table[(opcode | op_32) & recomp_opcode_mask]) {
+    if (recomp_op_table && codegen_recomp_valid(recomp_op_table, opcode) && recomp_op_table[(opcode | op_32) & recomp_opcode_mask]) {
         uint32_t new_pc = recomp_op_table[(opcode | op_32) & recomp_opcode_mask](block, ir, opcode, fetchdat, op_32, op_pc);
         if (new_pc) {
             if (new_pc != -1)
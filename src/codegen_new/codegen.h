@@ -30,6 +30,11 @@
   same page).
 */
 
+/*Number of successor links held by each codeblock - enough for both the taken
+  and not taken paths of a conditional branch*/
+#define CODEBLOCK_LINK_SLOT_BITS 1
+#define CODEBLOCK_LINK_SLOTS     (1 << CODEBLOCK_LINK_SLOT_BITS)
+
 typedef struct codeblock_t {
     uint32_t pc;
     uint32_t _cs;
@@ -38,6 +43,13 @@ typedef struct codeblock_t {
     uint16_t flags;
     uint8_t  ins;
     uint8_t  TOP;
+    /*Saturating execution count, decayed by the replacement clock. See
+      codegen_delete_cold_block()*/
+    uint8_t heat;
+    /*Saturating count of executions since the block was created or last
+      invalidated. Used to decide when to recompile the block, see
+      cpu_dynarec_threshold and cpu_dynarec_hot_threshold*/
+    uint16_t exec_count;
 
     /*Pointers for codeblock tree, used to search for blocks when hash lookup
       fails.*/
@@ -57,8 +69,43 @@ typedef struct codeblock_t {
     /*First mem_block_t used by this block. Any subsequent mem_block_ts
       will be in the list starting at head_mem_block->next.*/
     struct mem_block_t *head_mem_block;
+
+    /*Links to successor blocks. When a block exits to a PC that one of these
+      blocks starts at, the dispatcher enters the linked block without
+      translating the PC or looking it up again, as long as no TLB flush has
+      happened since the link was made (link_tlb_gen). Each link slot is also a
+      member of the incoming link list of the target block (starting at
+      link_in), so that all links to a block can be removed when it is
+      invalidated or deleted.
+
+      Slots are identified by codeblock_link_slot(); 0 is used as the list
+      terminator, which is safe as block 0 never links to anything.*/
+    uint16_t link[CODEBLOCK_LINK_SLOTS];
+    uint32_t link_prev[CODEBLOCK_LINK_SLOTS], link_next[CODEBLOCK_LINK_SLOTS];
+    uint32_t link_in;
+    uint64_t link_tlb_gen[CODEBLOCK_LINK_SLOTS];
 } codeblock_t;
 
+/*Slot ids used by the link lists, combining a block number and the index of
+  one of its link slots*/
+static inline uint32_t
+codeblock_link_slot(uint16_t block_nr, int nr)
+{
+    return ((uint32_t) block_nr << CODEBLOCK_LINK_SLOT_BITS) | nr;
+}
+
+static inline uint16_t
+codeblock_link_slot_block(uint32_t slot)
+{
+    return slot >> CODEBLOCK_LINK_SLOT_BITS;
+}
+
+static inline int
+codeblock_link_slot_nr(uint32_t slot)
+{
+    return slot & (CODEBLOCK_LINK_SLOTS - 1);
+}
+
 extern codeblock_t *codeblock;
 
 extern uint16_t *codeblock_hash;
@@ -81,6 +128,13 @@ extern uint8_t *block_write_data;
 #define CODEBLOCK_IN_DIRTY_LIST 0x40
 /*Code block is not inlining immediate parameters, parameters must be fetched from memory*/
 #define CODEBLOCK_NO_IMMEDIATES 0x80
+/*Code block is hot and has been recompiled with more aggressive optimisation*/
+#define CODEBLOCK_TIER2 0x100
+
+/*Maximum value of codeblock_t::heat*/
+#define CODEBLOCK_HEAT_MAX 7
+/*Maximum value of codeblock_t::exec_count*/
+#define CODEBLOCK_EXEC_COUNT_MAX 0xffff
 
 #define BLOCK_PC_INVALID        0xffffffff
 
@@ -92,6 +146,21 @@ get_block_nr(codeblock_t *block)
     return ((uintptr_t) block - (uintptr_t) codeblock) / sizeof(codeblock_t);
 }
 
+/*Return the block linked from block that starts at pc, or NULL if there is
+  no such link or the TLB has been flushed since it was made. The translation
+  and pages of the returned block were validated when the link was made, the
+  caller must still check CS, the CPU state and the page dirty masks.*/
+static inline codeblock_t *
+codeblock_link_find(codeblock_t *block, uint32_t pc)
+{
+    for (int c = 0; c < CODEBLOCK_LINK_SLOTS; c++) {
+        if (block->link[c] && (block->link_tlb_gen[c] == mem_tlb_flushes) && (codeblock[block->link[c]].pc == pc))
+            return &codeblock[block->link[c]];
+    }
+
+    return NULL;
+}
+
 static inline codeblock_t *
 codeblock_tree_find(uint32_t phys, uint32_t _cs)
 {
@@ -297,6 +366,8 @@ extern void codegen_block_start_recompile(codeblock_t *block);
 extern void codegen_block_end_recompile(codeblock_t *block);
 extern void codegen_block_end(void);
 extern void codegen_delete_block(codeblock_t *block);
+extern void codegen_block_link(codeblock_t *block, codeblock_t *target);
+extern void codegen_block_mark_hot(codeblock_t *block);
 extern void codegen_generate_call(uint8_t opcode, OpFn op, uint32_t fetchdat, uint32_t new_pc, uint32_t old_pc);
 extern void codegen_generate_seg_restore(void);
 extern void codegen_set_op32(void);
@@ -309,13 +380,33 @@ extern void codegen_check_seg_write(codeblock_t *block, struct ir_data_t *ir, x8
 extern void codegen_check_regs(void);
 
 extern int codegen_purge_purgable_list(void);
-/*Delete a random code block to free memory. This is obviously quite expensive, and
-  will only be called when the allocator is out of memory*/
-extern void codegen_delete_random_block(int required_mem_block);
+/*Delete the least recently executed code block to free memory. This is
+  quite expensive, and will only be called when the allocator is out of memory*/
+extern void codegen_delete_cold_block(int required_mem_block);
 
 extern int      cpu_block_end;
 extern uint32_t codegen_endpc;
 
+/*Last recompiled block executed by the dispatcher, or BLOCK_INVALID if the
+  previous transition can not be linked (interpreted code, exceptions,
+  interrupts)*/
+extern uint16_t codegen_block_last;
+
+/*Block cache hits are block_linked + block_dispatched*/
+typedef struct codegen_stats_t {
+    uint64_t block_linked;     /*Block transitions resolved through a successor link*/
+    uint64_t block_dispatched; /*Block transitions resolved through the hash table or tree*/
+    uint64_t block_misses;     /*Block entries with no compiled code, which were marked or recompiled*/
+    uint64_t block_evictions;  /*Blocks deleted to free codeblocks or memory blocks*/
+    uint64_t block_hint_hits; /*Blocks recompiled on first sight because of the compile hint cache*/
+    uint64_t block_interpreted; /*Block entries interpreted because the block is not yet hot enough to recompile*/
+    uint64_t block_tier2;       /*Blocks recompiled a second time because they are hot*/
+    uint64_t ir_uops_in;        /*uOPs generated, before the IR optimisation passes*/
+    uint64_t ir_uops_out;       /*uOPs remaining after the IR optimisation passes*/
+} codegen_stats_t;
+
+extern codegen_stats_t codegen_stats;
+
 extern int cpu_reps;
 extern int cpu_notreps;
 
@@ -335,6 +426,7 @@ typedef struct codegen_timing_t {
     void (*block_start)(void);
     void (*block_end)(void);
     int (*jump_cycles)(void);
+    void (*init)(void);
 } codegen_timing_t;
 
 extern codegen_timing_t codegen_timing_pentium;
@@ -348,6 +440,8 @@ extern codegen_timing_t codegen_timing_k7;
 extern codegen_timing_t codegen_timing_p6;
 
 void codegen_timing_set(codegen_timing_t *timing);
+void codegen_timing_init(void);
+void codegen_timing_common_init(void);
 
 extern int block_current;
 extern int block_pos;
@@ -54,12 +54,9 @@ codegen_allocator_allocate(mem_block_t *parent, int code_block)
     uint32_t     block_nr;
 
     while (!mem_block_free_list) {
-        /*Pick a random memory block and free the owning code block*/
-        block_nr = rand() & MEM_BLOCK_MASK;
-        block    = &mem_blocks[block_nr];
-
-        if (block->code_block && block->code_block != code_block)
-            codegen_delete_block(&codeblock[block->code_block]);
+        /*Free the memory of the coldest code block other than the one being
+          allocated for*/
+        codegen_delete_cold_block(1);
     }
 
     /*Remove from free list*/
@@ -111,6 +111,7 @@
 #    define OPCODE_BIC_V              (0x0e601c00)
 #    define OPCODE_BLR                (0xd63f0000)
 #    define OPCODE_BR                 (0xd61f0000)
+#    define OPCODE_BSL_V              (0x2e601c00)
 #    define OPCODE_CMEQ_V8B           (0x2e208c00)
 #    define OPCODE_CMEQ_V4H           (0x2e608c00)
 #    define OPCODE_CMEQ_V2S           (0x2ea08c00)
@@ -139,6 +140,7 @@
 #    define OPCODE_FCVTZS_V2S         (0x0ea1b800)
 #    define OPCODE_FDIV_D             (0x1e601800)
 #    define OPCODE_FDIV_S             (0x1e201800)
+#    define OPCODE_FDIV_V2S           (0x2e20fc00)
 #    define OPCODE_FMAX_V2S           (0x0e20f400)
 #    define OPCODE_FMIN_V2S           (0x0ea0f400)
 #    define OPCODE_FMOV_D_D           (0x1e604000)
@@ -153,6 +155,7 @@
 #    define OPCODE_FRINTX_D           (0x1e674000)
 #    define OPCODE_FSQRT_D            (0x1e61c000)
 #    define OPCODE_FSQRT_S            (0x1e21c000)
+#    define OPCODE_FSQRT_V2S          (0x2ea1f800)
 #    define OPCODE_FSUB_D             (0x1e603800)
 #    define OPCODE_FSUB_V2S           (0x0ea0d400)
 #    define OPCODE_LDR_REG            (0xb8606800)
@@ -181,6 +184,7 @@
 #    define OPCODE_SQSUB_V4H          (0x0e602c00)
 #    define OPCODE_SQXTN_V8B_8H       (0x0e214800)
 #    define OPCODE_SQXTN_V4H_4S       (0x0e614800)
+#    define OPCODE_SQXTUN_V8B_8H      (0x2e212800)
 #    define OPCODE_SHL_VD             (0x0f005400)
 #    define OPCODE_SHL_VQ             (0x4f005400)
 #    define OPCODE_SHRN               (0x0f008400)
@@ -207,6 +211,7 @@
 #    define OPCODE_ZIP1_V8B           (0x0e003800)
 #    define OPCODE_ZIP1_V4H           (0x0e403800)
 #    define OPCODE_ZIP1_V2S           (0x0e803800)
+#    define OPCODE_ZIP1_V2D           (0x4ec03800)
 #    define OPCODE_ZIP2_V8B           (0x0e007800)
 #    define OPCODE_ZIP2_V4H           (0x0e407800)
 #    define OPCODE_ZIP2_V2S           (0x0e807800)
@@ -598,6 +603,12 @@ host_arm64_BIC_REG_V(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_r
     codegen_addlong(block, OPCODE_BIC_V | Rd(dst_reg) | Rn(src_n_reg) | Rm(src_m_reg));
 }
 
+void
+host_arm64_BSL_REG_V(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg)
+{
+    codegen_addlong(block, OPCODE_BSL_V | Rd(dst_reg) | Rn(src_n_reg) | Rm(src_m_reg));
+}
+
 void
 host_arm64_CBNZ(codeblock_t *block, int reg, uintptr_t dest)
 {
@@ -844,6 +855,11 @@ host_arm64_FDIV_S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg)
 {
     codegen_addlong(block, OPCODE_FDIV_S | Rd(dst_reg) | Rn(src_n_reg) | Rm(src_m_reg));
 }
+void
+host_arm64_FDIV_V2S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg)
+{
+    codegen_addlong(block, OPCODE_FDIV_V2S | Rd(dst_reg) | Rn(src_n_reg) | Rm(src_m_reg));
+}
 
 void
 host_arm64_FMAX_V2S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg)
@@ -931,6 +947,11 @@ host_arm64_FSQRT_S(codeblock_t *block, int dst_reg, int src_reg)
 {
     codegen_addlong(block, OPCODE_FSQRT_S | Rd(dst_reg) | Rn(src_reg));
 }
+void
+host_arm64_FSQRT_V2S(codeblock_t *block, int dst_reg, int src_reg)
+{
+    codegen_addlong(block, OPCODE_FSQRT_V2S | Rd(dst_reg) | Rn(src_reg));
+}
 
 void
 host_arm64_LDP_POSTIDX_X(codeblock_t *block, int src_reg1, int src_reg2, int base_reg, int offset)
@@ -1230,6 +1251,11 @@ host_arm64_SQXTN_V4H_4S(codeblock_t *block, int dst_reg, int src_reg)
 {
     codegen_addlong(block, OPCODE_SQXTN_V4H_4S | Rd(dst_reg) | Rn(src_reg));
 }
+void
+host_arm64_SQXTUN_V8B_8H(codeblock_t *block, int dst_reg, int src_reg)
+{
+    codegen_addlong(block, OPCODE_SQXTUN_V8B_8H | Rd(dst_reg) | Rn(src_reg));
+}
 
 void
 host_arm64_SHL_V4H(codeblock_t *block, int dst_reg, int src_n_reg, int shift)
@@ -1475,6 +1501,11 @@ host_arm64_ZIP1_V2S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_re
     codegen_addlong(block, OPCODE_ZIP1_V2S | Rd(dst_reg) | Rn(src_n_reg) | Rm(src_m_reg));
 }
 void
+host_arm64_ZIP1_V2D(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg)
+{
+    codegen_addlong(block, OPCODE_ZIP1_V2D | Rd(dst_reg) | Rn(src_n_reg) | Rm(src_m_reg));
+}
+void
 host_arm64_ZIP2_V8B(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg)
 {
     codegen_addlong(block, OPCODE_ZIP2_V8B | Rd(dst_reg) | Rn(src_n_reg) | Rm(src_m_reg));
@@ -49,6 +49,8 @@ void host_arm64_BR(codeblock_t *block, int addr_reg);
 
 void host_arm64_BIC_REG_V(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 
+void host_arm64_BSL_REG_V(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
+
 void host_arm64_CBNZ(codeblock_t *block, int reg, uintptr_t dest);
 
 void host_arm64_CMEQ_V8B(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
@@ -87,6 +89,7 @@ void host_arm64_FCMGT_V2S(codeblock_t *block, int dst_reg, int src_n_reg, int sr
 void host_arm64_FCMP_D(codeblock_t *block, int src_n_reg, int src_m_reg);
 void host_arm64_FDIV_D(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 void host_arm64_FDIV_S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
+void host_arm64_FDIV_V2S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 void host_arm64_FMAX_V2S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 void host_arm64_FMIN_V2S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 void host_arm64_FMUL_D(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
@@ -120,6 +123,7 @@ void host_arm64_FRINTX_D(codeblock_t *block, int dst_reg, int src_reg);
 
 void host_arm64_FSQRT_D(codeblock_t *block, int dst_reg, int src_reg);
 void host_arm64_FSQRT_S(codeblock_t *block, int dst_reg, int src_reg);
+void host_arm64_FSQRT_V2S(codeblock_t *block, int dst_reg, int src_reg);
 
 void host_arm64_LDP_POSTIDX_X(codeblock_t *block, int src_reg1, int src_reg2, int base_reg, int offset);
 
@@ -185,6 +189,7 @@ void host_arm64_SQSUB_V4H(codeblock_t *block, int dst_reg, int src_n_reg, int sr
 
 void host_arm64_SQXTN_V8B_8H(codeblock_t *block, int dst_reg, int src_reg);
 void host_arm64_SQXTN_V4H_4S(codeblock_t *block, int dst_reg, int src_reg);
+void host_arm64_SQXTUN_V8B_8H(codeblock_t *block, int dst_reg, int src_reg);
 
 void host_arm64_SHL_V4H(codeblock_t *block, int dst_reg, int src_reg, int shift);
 void host_arm64_SHL_V2S(codeblock_t *block, int dst_reg, int src_reg, int shift);
@@ -243,6 +248,7 @@ void host_arm64_USHR_V2D(codeblock_t *block, int dst_reg, int src_reg, int shift
 void host_arm64_ZIP1_V8B(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 void host_arm64_ZIP1_V4H(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 void host_arm64_ZIP1_V2S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
+void host_arm64_ZIP1_V2D(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 void host_arm64_ZIP2_V8B(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 void host_arm64_ZIP2_V4H(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
 void host_arm64_ZIP2_V2S(codeblock_t *block, int dst_reg, int src_n_reg, int src_m_reg);
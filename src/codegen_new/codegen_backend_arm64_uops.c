@@ -1447,9 +1447,8 @@ codegen_PACKSSWB(codeblock_t *block, uop_t *uop)
     int src_size_b = IREG_GET_SIZE(uop->src_reg_b_real);
 
     if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_b) && uop->dest_reg_a_real == uop->src_reg_a_real) {
-        host_arm64_SQXTN_V8B_8H(block, REG_V_TEMP, src_reg_b);
-        host_arm64_SQXTN_V8B_8H(block, dest_reg, dest_reg);
-        host_arm64_ZIP1_V2S(block, dest_reg, dest_reg, REG_V_TEMP);
+        host_arm64_ZIP1_V2D(block, REG_V_TEMP, dest_reg, src_reg_b);
+        host_arm64_SQXTN_V8B_8H(block, dest_reg, REG_V_TEMP);
     } else
         fatal("PACKSSWB %02x %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real, uop->src_reg_b_real);
 
@@ -1464,9 +1463,8 @@ codegen_PACKSSDW(codeblock_t *block, uop_t *uop)
     int src_size_b = IREG_GET_SIZE(uop->src_reg_b_real);
 
     if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_b) && uop->dest_reg_a_real == uop->src_reg_a_real) {
-        host_arm64_SQXTN_V4H_4S(block, REG_V_TEMP, src_reg_b);
-        host_arm64_SQXTN_V4H_4S(block, dest_reg, dest_reg);
-        host_arm64_ZIP1_V2S(block, dest_reg, dest_reg, REG_V_TEMP);
+        host_arm64_ZIP1_V2D(block, REG_V_TEMP, dest_reg, src_reg_b);
+        host_arm64_SQXTN_V4H_4S(block, dest_reg, REG_V_TEMP);
     } else
         fatal("PACKSSDW %02x %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real, uop->src_reg_b_real);
 
@@ -1479,9 +1477,8 @@ codegen_PACKUSWB(codeblock_t *block, uop_t *uop)
     int dest_size = IREG_GET_SIZE(uop->dest_reg_a_real), src_size_b = IREG_GET_SIZE(uop->src_reg_b_real);
 
     if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_b) && uop->dest_reg_a_real == uop->src_reg_a_real) {
-        host_arm64_UQXTN_V8B_8H(block, REG_V_TEMP, src_reg_b);
-        host_arm64_UQXTN_V8B_8H(block, dest_reg, dest_reg);
-        host_arm64_ZIP1_V2S(block, dest_reg, dest_reg, REG_V_TEMP);
+        host_arm64_ZIP1_V2D(block, REG_V_TEMP, dest_reg, src_reg_b);
+        host_arm64_SQXTUN_V8B_8H(block, dest_reg, REG_V_TEMP);
     } else
         fatal("PACKUSWB %02x %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real, uop->src_reg_b_real);
 
@@ -1915,6 +1912,79 @@ codegen_PI2FD(codeblock_t *block, uop_t *uop)
     return 0;
 }
 
+static int
+codegen_DIVPS(codeblock_t *block, uop_t *uop)
+{
+    int dest_reg   = HOST_REG_GET(uop->dest_reg_a_real);
+    int src_reg_a  = HOST_REG_GET(uop->src_reg_a_real);
+    int src_reg_b  = HOST_REG_GET(uop->src_reg_b_real);
+    int dest_size  = IREG_GET_SIZE(uop->dest_reg_a_real);
+    int src_size_a = IREG_GET_SIZE(uop->src_reg_a_real);
+    int src_size_b = IREG_GET_SIZE(uop->src_reg_b_real);
+
+    if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_a) && REG_IS_Q(src_size_b)) {
+        host_arm64_FDIV_V2S(block, dest_reg, src_reg_a, src_reg_b);
+    } else
+        fatal("DIVPS %02x %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real, uop->src_reg_b_real);
+
+    return 0;
+}
+static int
+codegen_MAXPS(codeblock_t *block, uop_t *uop)
+{
+    int dest_reg   = HOST_REG_GET(uop->dest_reg_a_real);
+    int src_reg_a  = HOST_REG_GET(uop->src_reg_a_real);
+    int src_reg_b  = HOST_REG_GET(uop->src_reg_b_real);
+    int dest_size  = IREG_GET_SIZE(uop->dest_reg_a_real);
+    int src_size_a = IREG_GET_SIZE(uop->src_reg_a_real);
+    int src_size_b = IREG_GET_SIZE(uop->src_reg_b_real);
+
+    if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_a) && REG_IS_Q(src_size_b)) {
+        /*FMAX returns NaN if either operand is NaN, SSE returns the second operand*/
+        host_arm64_FCMGT_V2S(block, REG_V_TEMP, src_reg_a, src_reg_b);
+        host_arm64_BSL_REG_V(block, REG_V_TEMP, src_reg_a, src_reg_b);
+        host_arm64_FMOV_D_D(block, dest_reg, REG_V_TEMP);
+    } else
+        fatal("MAXPS %02x %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real, uop->src_reg_b_real);
+
+    return 0;
+}
+static int
+codegen_MINPS(codeblock_t *block, uop_t *uop)
+{
+    int dest_reg   = HOST_REG_GET(uop->dest_reg_a_real);
+    int src_reg_a  = HOST_REG_GET(uop->src_reg_a_real);
+    int src_reg_b  = HOST_REG_GET(uop->src_reg_b_real);
+    int dest_size  = IREG_GET_SIZE(uop->dest_reg_a_real);
+    int src_size_a = IREG_GET_SIZE(uop->src_reg_a_real);
+    int src_size_b = IREG_GET_SIZE(uop->src_reg_b_real);
+
+    if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_a) && REG_IS_Q(src_size_b)) {
+        /*FMIN returns NaN if either operand is NaN, SSE returns the second operand*/
+        host_arm64_FCMGT_V2S(block, REG_V_TEMP, src_reg_b, src_reg_a);
+        host_arm64_BSL_REG_V(block, REG_V_TEMP, src_reg_a, src_reg_b);
+        host_arm64_FMOV_D_D(block, dest_reg, REG_V_TEMP);
+    } else
+        fatal("MINPS %02x %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real, uop->src_reg_b_real);
+
+    return 0;
+}
+static int
+codegen_SQRTPS(codeblock_t *block, uop_t *uop)
+{
+    int dest_reg   = HOST_REG_GET(uop->dest_reg_a_real);
+    int src_reg_a  = HOST_REG_GET(uop->src_reg_a_real);
+    int dest_size  = IREG_GET_SIZE(uop->dest_reg_a_real);
+    int src_size_a = IREG_GET_SIZE(uop->src_reg_a_real);
+
+    if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_a)) {
+        host_arm64_FSQRT_V2S(block, dest_reg, src_reg_a);
+    } else
+        fatal("SQRTPS %02x\n", uop->dest_reg_a_real);
+
+    return 0;
+}
+
 static int
 codegen_PMADDWD(codeblock_t *block, uop_t *uop)
 {
@@ -3283,6 +3353,19 @@ const uOpFn uop_handlers[UOP_MAX] = {
         UOP_MASK]
     = codegen_PI2FD,
 
+    [UOP_DIVPS &
+        UOP_MASK]
+    = codegen_DIVPS,
+    [UOP_SQRTPS &
+        UOP_MASK]
+    = codegen_SQRTPS,
+    [UOP_MAXPS &
+        UOP_MASK]
+    = codegen_MAXPS,
+    [UOP_MINPS &
+        UOP_MASK]
+    = codegen_MINPS,
+
     [UOP_PMADDWD &
         UOP_MASK]
     = codegen_PMADDWD,
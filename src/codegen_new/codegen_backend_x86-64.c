@@ -53,22 +53,39 @@ host_reg_def_t codegen_host_reg_list[CODEGEN_HOST_REGS] = {
 };
 
 host_reg_def_t codegen_host_fp_reg_list[CODEGEN_HOST_FP_REGS] = {
-#    if _WIN64
-  /*Windows x86-64 calling convention preserves XMM6-XMM15*/
-    {REG_XMM6,  0                     },
-    { REG_XMM7, 0                     },
-#    else
-    /*System V AMD64 calling convention does not preserve any XMM registers*/
-    { REG_XMM6, HOST_REG_FLAG_VOLATILE },
-    { REG_XMM7, HOST_REG_FLAG_VOLATILE },
-#    endif
-    { REG_XMM1, HOST_REG_FLAG_VOLATILE},
-    { REG_XMM2, HOST_REG_FLAG_VOLATILE},
-    { REG_XMM3, HOST_REG_FLAG_VOLATILE},
-    { REG_XMM4, HOST_REG_FLAG_VOLATILE},
-    { REG_XMM5, HOST_REG_FLAG_VOLATILE}
+  /*Note: the System V AMD64 calling convention does not preserve any XMM
+  registers, and the Windows x86-64 calling convention only preserves
+  XMM6-XMM15. The load/store routines save and restore all of these around
+  calls to the memory functions, so MMX, SSE and x87 values can stay in host
+  registers across memory accesses*/
+    {REG_XMM6,  0},
+    { REG_XMM7, 0},
+    { REG_XMM1, 0},
+    { REG_XMM2, 0},
+    { REG_XMM3, 0},
+    { REG_XMM4, 0},
+    { REG_XMM5, 0}
 };
 
+/*The recompiler only keeps 64-bit values in XMM registers, so only the low
+  halves need to be preserved*/
+#    define FP_REG_SAVE_SIZE 0x40
+
+static void
+build_fp_reg_save(codeblock_t *block)
+{
+    host_x86_SUB64_REG_IMM(block, REG_RSP, FP_REG_SAVE_SIZE);
+    for (int c = 0; c < CODEGEN_HOST_FP_REGS; c++)
+        host_x86_MOVQ_BASE_OFFSET_XREG(block, REG_RSP, c * 8, codegen_host_fp_reg_list[c].reg);
+}
+static void
+build_fp_reg_restore(codeblock_t *block)
+{
+    for (int c = 0; c < CODEGEN_HOST_FP_REGS; c++)
+        host_x86_MOVQ_XREG_BASE_OFFSET(block, codegen_host_fp_reg_list[c].reg, REG_RSP, c * 8);
+    host_x86_ADD64_REG_IMM(block, REG_RSP, FP_REG_SAVE_SIZE);
+}
+
 static void
 build_load_routine(codeblock_t *block, int size, int is_float)
 {
@@ -125,6 +142,7 @@ build_load_routine(codeblock_t *block, int size, int is_float)
         *misaligned_offset = (uint8_t) ((uintptr_t) &block_write_data[block_pos] - (uintptr_t) misaligned_offset) - 1;
     host_x86_PUSH(block, REG_RAX);
     host_x86_PUSH(block, REG_RDX);
+    build_fp_reg_save(block);
 #    if _WIN64
     host_x86_SUB64_REG_IMM(block, REG_RSP, 0x20);
     // host_x86_MOV32_REG_REG(block, REG_ECX, uop->imm_data);
@@ -151,6 +169,7 @@ build_load_routine(codeblock_t *block, int size, int is_float)
 #    if _WIN64
     host_x86_ADD64_REG_IMM(block, REG_RSP, 0x20);
 #    endif
+    build_fp_reg_restore(block);
     host_x86_POP(block, REG_RDX);
     host_x86_POP(block, REG_RAX);
     host_x86_MOVZX_REG_ABS_32_8(block, REG_ESI, &cpu_state.abrt);
@@ -214,6 +233,7 @@ build_store_routine(codeblock_t *block, int size, int is_float)
         *misaligned_offset = (uint8_t) ((uintptr_t) &block_write_data[block_pos] - (uintptr_t) misaligned_offset) - 1;
     host_x86_PUSH(block, REG_RAX);
     host_x86_PUSH(block, REG_RDX);
+    build_fp_reg_save(block);
 #    if _WIN64
     host_x86_SUB64_REG_IMM(block, REG_RSP, 0x28);
     if (size == 4 && is_float)
@@ -246,6 +266,7 @@ build_store_routine(codeblock_t *block, int size, int is_float)
 #    else
     host_x86_ADD64_REG_IMM(block, REG_RSP, 0x8);
 #    endif
+    build_fp_reg_restore(block);
     host_x86_POP(block, REG_RDX);
     host_x86_POP(block, REG_RAX);
     host_x86_MOVZX_REG_ABS_32_8(block, REG_ESI, &cpu_state.abrt);
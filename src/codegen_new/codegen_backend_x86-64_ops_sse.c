@@ -107,6 +107,12 @@ host_x86_CVTSS2SD_XREG_BASE_INDEX(codeblock_t *block, int dst_reg, int base_reg,
     codegen_addbyte(block, base_reg | (idx_reg << 3));
 }
 
+void
+host_x86_DIVPS_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg)
+{
+    codegen_alloc_bytes(block, 3);
+    codegen_addbyte3(block, 0x0f, 0x5e, 0xc0 | src_reg | (dst_reg << 3)); /*DIVPS dst_reg, src_reg*/
+}
 void
 host_x86_DIVSD_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg)
 {
@@ -493,6 +499,14 @@ host_x86_PMULLW_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg)
     codegen_addbyte4(block, 0x66, 0x0f, 0xd5, 0xc0 | src_reg | (dst_reg << 3)); /*PMULLW dst_reg, src_reg*/
 }
 
+void
+host_x86_PSHUFD_XREG_XREG_IMM(codeblock_t *block, int dst_reg, int src_reg, uint8_t shuffle)
+{
+    codegen_alloc_bytes(block, 5);
+    codegen_addbyte4(block, 0x66, 0x0f, 0x70, 0xc0 | src_reg | (dst_reg << 3)); /*PSHUFD dst_reg, src_reg, imm*/
+    codegen_addbyte(block, shuffle);
+}
+
 void
 host_x86_PSLLW_XREG_IMM(codeblock_t *block, int dst_reg, int shift)
 {
@@ -529,13 +543,6 @@ host_x86_PSRAD_XREG_IMM(codeblock_t *block, int dst_reg, int shift)
     codegen_addbyte(block, shift);
 }
 void
-host_x86_PSRAQ_XREG_IMM(codeblock_t *block, int dst_reg, int shift)
-{
-    codegen_alloc_bytes(block, 5);
-    codegen_addbyte4(block, 0x66, 0x0f, 0x73, 0xc0 | 0x20 | dst_reg); /*PSRAD dst_reg, imm*/
-    codegen_addbyte(block, shift);
-}
-void
 host_x86_PSRLW_XREG_IMM(codeblock_t *block, int dst_reg, int shift)
 {
     codegen_alloc_bytes(block, 5);
@@ -643,6 +650,12 @@ host_x86_PUNPCKLDQ_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg)
     codegen_addbyte4(block, 0x66, 0x0f, 0x62, 0xc0 | src_reg | (dst_reg << 3)); /*PUNPCKLDQ dst_reg, src_reg*/
 }
 
+void
+host_x86_SQRTPS_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg)
+{
+    codegen_alloc_bytes(block, 3);
+    codegen_addbyte3(block, 0x0f, 0x51, 0xc0 | src_reg | (dst_reg << 3)); /*SQRTPS dst_reg, src_reg*/
+}
 void
 host_x86_SQRTSD_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg)
 {
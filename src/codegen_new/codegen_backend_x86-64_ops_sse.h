@@ -20,6 +20,7 @@ void host_x86_CVTSI2SS_XREG_REG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_CVTSS2SD_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_CVTSS2SD_XREG_BASE_INDEX(codeblock_t *block, int dst_reg, int base_reg, int idx_reg);
 
+void host_x86_DIVPS_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_DIVSD_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_DIVSS_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 
@@ -80,12 +81,13 @@ void host_x86_PMADDWD_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_PMULHW_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_PMULLW_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 
+void host_x86_PSHUFD_XREG_XREG_IMM(codeblock_t *block, int dst_reg, int src_reg, uint8_t shuffle);
+
 void host_x86_PSLLW_XREG_IMM(codeblock_t *block, int dst_reg, int shift);
 void host_x86_PSLLD_XREG_IMM(codeblock_t *block, int dst_reg, int shift);
 void host_x86_PSLLQ_XREG_IMM(codeblock_t *block, int dst_reg, int shift);
 void host_x86_PSRAW_XREG_IMM(codeblock_t *block, int dst_reg, int shift);
 void host_x86_PSRAD_XREG_IMM(codeblock_t *block, int dst_reg, int shift);
-void host_x86_PSRAQ_XREG_IMM(codeblock_t *block, int dst_reg, int shift);
 void host_x86_PSRLW_XREG_IMM(codeblock_t *block, int dst_reg, int shift);
 void host_x86_PSRLD_XREG_IMM(codeblock_t *block, int dst_reg, int shift);
 void host_x86_PSRLQ_XREG_IMM(codeblock_t *block, int dst_reg, int shift);
@@ -105,6 +107,7 @@ void host_x86_PUNPCKLBW_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_PUNPCKLWD_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_PUNPCKLDQ_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 
+void host_x86_SQRTPS_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_SQRTSD_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 void host_x86_SQRTSS_XREG_XREG(codeblock_t *block, int dst_reg, int src_reg);
 
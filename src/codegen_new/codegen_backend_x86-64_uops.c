@@ -2003,6 +2003,75 @@ codegen_PI2FD(codeblock_t *block, uop_t *uop)
     return 0;
 }
 
+static int
+codegen_DIVPS(codeblock_t *block, uop_t *uop)
+{
+    int dest_reg   = HOST_REG_GET(uop->dest_reg_a_real);
+    int src_reg_b  = HOST_REG_GET(uop->src_reg_b_real);
+    int dest_size  = IREG_GET_SIZE(uop->dest_reg_a_real);
+    int src_size_b = IREG_GET_SIZE(uop->src_reg_b_real);
+
+    if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_b) && uop->dest_reg_a_real == uop->src_reg_a_real) {
+        host_x86_DIVPS_XREG_XREG(block, dest_reg, src_reg_b);
+    }
+#    ifdef RECOMPILER_DEBUG
+    else
+        fatal("DIVPS %02x %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real, uop->src_reg_b_real);
+#    endif
+    return 0;
+}
+static int
+codegen_MAXPS(codeblock_t *block, uop_t *uop)
+{
+    int dest_reg   = HOST_REG_GET(uop->dest_reg_a_real);
+    int src_reg_b  = HOST_REG_GET(uop->src_reg_b_real);
+    int dest_size  = IREG_GET_SIZE(uop->dest_reg_a_real);
+    int src_size_b = IREG_GET_SIZE(uop->src_reg_b_real);
+
+    if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_b) && uop->dest_reg_a_real == uop->src_reg_a_real) {
+        host_x86_MAXPS_XREG_XREG(block, dest_reg, src_reg_b);
+    }
+#    ifdef RECOMPILER_DEBUG
+    else
+        fatal("MAXPS %02x %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real, uop->src_reg_b_real);
+#    endif
+    return 0;
+}
+static int
+codegen_MINPS(codeblock_t *block, uop_t *uop)
+{
+    int dest_reg   = HOST_REG_GET(uop->dest_reg_a_real);
+    int src_reg_b  = HOST_REG_GET(uop->src_reg_b_real);
+    int dest_size  = IREG_GET_SIZE(uop->dest_reg_a_real);
+    int src_size_b = IREG_GET_SIZE(uop->src_reg_b_real);
+
+    if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_b) && uop->dest_reg_a_real == uop->src_reg_a_real) {
+        host_x86_MINPS_XREG_XREG(block, dest_reg, src_reg_b);
+    }
+#    ifdef RECOMPILER_DEBUG
+    else
+        fatal("MINPS %02x %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real, uop->src_reg_b_real);
+#    endif
+    return 0;
+}
+static int
+codegen_SQRTPS(codeblock_t *block, uop_t *uop)
+{
+    int dest_reg   = HOST_REG_GET(uop->dest_reg_a_real);
+    int src_reg_a  = HOST_REG_GET(uop->src_reg_a_real);
+    int dest_size  = IREG_GET_SIZE(uop->dest_reg_a_real);
+    int src_size_a = IREG_GET_SIZE(uop->src_reg_a_real);
+
+    if (REG_IS_Q(dest_size) && REG_IS_Q(src_size_a)) {
+        host_x86_SQRTPS_XREG_XREG(block, dest_reg, src_reg_a);
+    }
+#    ifdef RECOMPILER_DEBUG
+    else
+        fatal("SQRTPS %02x %02x\n", uop->dest_reg_a_real, uop->src_reg_a_real);
+#    endif
+    return 0;
+}
+
 static int
 codegen_PMADDWD(codeblock_t *block, uop_t *uop)
 {
@@ -2137,7 +2206,18 @@ codegen_PSRAQ_IMM(codeblock_t *block, uop_t *uop)
     int dest_size = IREG_GET_SIZE(uop->dest_reg_a_real);
 
     if (REG_IS_Q(dest_size) && uop->dest_reg_a_real == uop->src_reg_a_real) {
-        host_x86_PSRAQ_XREG_IMM(block, dest_reg, uop->imm_data);
+        int shift = (uop->imm_data > 63) ? 63 : uop->imm_data;
+
+        /*SSE2 has no 64-bit arithmetic shift, so OR the sign extension into
+          the result of a logical shift*/
+        if (shift) {
+            host_x86_MOVQ_XREG_XREG(block, REG_XMM_TEMP, dest_reg);
+            host_x86_PSRAD_XREG_IMM(block, REG_XMM_TEMP, 31);
+            host_x86_PSHUFD_XREG_XREG_IMM(block, REG_XMM_TEMP, REG_XMM_TEMP, 0x55);
+            host_x86_PSRLQ_XREG_IMM(block, dest_reg, shift);
+            host_x86_PSLLQ_XREG_IMM(block, REG_XMM_TEMP, 64 - shift);
+            host_x86_POR_XREG_XREG(block, dest_reg, REG_XMM_TEMP);
+        }
     }
 #    ifdef RECOMPILER_DEBUG
     else
@@ -3235,6 +3315,19 @@ const uOpFn uop_handlers[UOP_MAX] = {
         UOP_MASK]
     = codegen_PI2FD,
 
+    [UOP_DIVPS &
+        UOP_MASK]
+    = codegen_DIVPS,
+    [UOP_SQRTPS &
+        UOP_MASK]
+    = codegen_SQRTPS,
+    [UOP_MAXPS &
+        UOP_MASK]
+    = codegen_MAXPS,
+    [UOP_MINPS &
+        UOP_MASK]
+    = codegen_MINPS,
+
     [UOP_PMADDWD &
         UOP_MASK]
     = codegen_PMADDWD,
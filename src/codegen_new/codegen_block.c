@@ -21,6 +21,7 @@
 #include "codegen_accumulate.h"
 #include "codegen_allocator.h"
 #include "codegen_backend.h"
+#include "codegen_hint_cache.h"
 #include "codegen_ir.h"
 #include "codegen_reg.h"
 
@@ -28,6 +29,7 @@ uint8_t *block_write_data = NULL;
 
 int      codegen_flat_ds;
 int      codegen_flat_ss;
+int      codegen_default_mxcsr;
 int      mmx_ebx_ecx_loaded;
 int      codegen_flags_changed = 0;
 int      codegen_fpu_entered   = 0;
@@ -45,6 +47,9 @@ int        block_pos;
 
 uint32_t codegen_endpc;
 
+uint16_t        codegen_block_last = BLOCK_INVALID;
+codegen_stats_t codegen_stats;
+
 int        codegen_block_cycles;
 static int codegen_block_ins;
 static int codegen_block_full_ins;
@@ -160,6 +165,94 @@ block_dirty_list_remove(codeblock_t *block)
     block->flags &= ~CODEBLOCK_IN_DIRTY_LIST;
 }
 
+/*Successor links. A block has CODEBLOCK_LINK_SLOTS outgoing links, each of
+  which is also on the incoming list of the block it points to. This allows
+  all links to a block to be removed when it is invalidated or deleted, so the
+  dispatcher never follows a link into a block that no longer exists.*/
+static void
+block_link_remove_slot(uint32_t slot)
+{
+    codeblock_t *block  = &codeblock[codeblock_link_slot_block(slot)];
+    int          nr     = codeblock_link_slot_nr(slot);
+    codeblock_t *target = &codeblock[block->link[nr]];
+    uint32_t     prev   = block->link_prev[nr];
+    uint32_t     next   = block->link_next[nr];
+
+    if (prev)
+        codeblock[codeblock_link_slot_block(prev)].link_next[codeblock_link_slot_nr(prev)] = next;
+    else
+        target->link_in = next;
+    if (next)
+        codeblock[codeblock_link_slot_block(next)].link_prev[codeblock_link_slot_nr(next)] = prev;
+
+    block->link[nr]      = BLOCK_INVALID;
+    block->link_prev[nr] = block->link_next[nr] = 0;
+}
+
+static void
+block_unlink(codeblock_t *block)
+{
+    uint16_t block_nr = get_block_nr(block);
+
+    for (int c = 0; c < CODEBLOCK_LINK_SLOTS; c++) {
+        if (block->link[c])
+            block_link_remove_slot(codeblock_link_slot(block_nr, c));
+    }
+    while (block->link_in)
+        block_link_remove_slot(block->link_in);
+
+    if (codegen_block_last == block_nr)
+        codegen_block_last = BLOCK_INVALID;
+}
+
+void
+codegen_block_link(codeblock_t *block, codeblock_t *target)
+{
+    uint16_t block_nr  = get_block_nr(block);
+    uint16_t target_nr = get_block_nr(target);
+    uint32_t slot;
+    int      nr;
+
+    /*Only link live, compiled blocks*/
+    if ((block->flags & (CODEBLOCK_WAS_RECOMPILED | CODEBLOCK_IN_DIRTY_LIST | CODEBLOCK_IN_FREE_LIST)) != CODEBLOCK_WAS_RECOMPILED)
+        return;
+    if (block_nr == BLOCK_INVALID || block->pc == BLOCK_PC_INVALID)
+        return;
+
+    /*Only link to targets on a page that has been validated for the source
+      block; either its first page, or the second page if it spans two*/
+    if (((target->phys ^ block->phys) & ~0xfff) && (!(block->flags & CODEBLOCK_HAS_PAGE2) || ((target->phys ^ block->phys_2) & ~0xfff)))
+        return;
+
+    /*The caller has just validated the target for the current translation,
+      so an existing link to it only needs its TLB generation brought up to
+      date*/
+    for (nr = 0; nr < CODEBLOCK_LINK_SLOTS; nr++) {
+        if (block->link[nr] == target_nr) {
+            block->link_tlb_gen[nr] = mem_tlb_flushes;
+            return;
+        }
+    }
+
+    /*Use a free slot if there is one, otherwise replace the last slot. This
+      keeps the first successor seen (usually the hot path) linked*/
+    for (nr = 0; nr < CODEBLOCK_LINK_SLOTS - 1; nr++) {
+        if (!block->link[nr])
+            break;
+    }
+    slot = codeblock_link_slot(block_nr, nr);
+    if (block->link[nr])
+        block_link_remove_slot(slot);
+
+    block->link[nr]         = target_nr;
+    block->link_tlb_gen[nr] = mem_tlb_flushes;
+    block->link_prev[nr]    = 0;
+    block->link_next[nr]    = target->link_in;
+    if (target->link_in)
+        codeblock[codeblock_link_slot_block(target->link_in)].link_prev[codeblock_link_slot_nr(target->link_in)] = slot;
+    target->link_in = slot;
+}
+
 int
 codegen_purge_purgable_list(void)
 {
@@ -204,7 +297,7 @@ block_free_list_get(void)
         }
         /*Free list is empty - free up a block*/
         if (!codegen_purge_purgable_list())
-            codegen_delete_random_block(0);
+            codegen_delete_cold_block(0);
     }
 
     block           = &codeblock[block_free_list];
@@ -249,6 +342,7 @@ codegen_reset(void)
     memset(codeblock, 0, BLOCK_SIZE * sizeof(codeblock_t));
     memset(codeblock_hash, 0, HASH_SIZE * sizeof(uint16_t));
     mem_reset_page_blocks();
+    codegen_block_last = BLOCK_INVALID;
 
     block_free_list = 0;
     for (c = 0; c < BLOCK_SIZE; c++) {
@@ -377,8 +471,10 @@ invalidate_block(codeblock_t *block)
     if (block->pc == BLOCK_PC_INVALID)
         fatal("Invalidating deleted block\n");
 #endif
+    block_unlink(block);
     remove_from_block_list(block, old_pc);
     block_dirty_list_add(block);
+    block->exec_count = 0;
     if (block->head_mem_block)
         codegen_allocator_free(block->head_mem_block);
     block->head_mem_block = NULL;
@@ -398,6 +494,7 @@ delete_block(codeblock_t *block)
 #endif
     block->pc = BLOCK_PC_INVALID;
 
+    block_unlink(block);
     codeblock_tree_delete(block);
     if (block->flags & CODEBLOCK_IN_DIRTY_LIST)
         block_dirty_list_remove(block);
@@ -421,6 +518,7 @@ delete_dirty_block(codeblock_t *block)
 #endif
     block->pc = BLOCK_PC_INVALID;
 
+    block_unlink(block);
     codeblock_tree_delete(block);
     block_free_list_add(block);
 }
@@ -432,21 +530,32 @@ codegen_delete_block(codeblock_t *block)
         delete_block(block);
 }
 
+/*Block replacement uses a generalised CLOCK algorithm. The dispatcher
+  increments a block's heat each time it is executed (up to CODEBLOCK_HEAT_MAX),
+  and each pass of the clock hand over a block decrements it. The first block
+  found with no heat left is evicted, so blocks that keep being executed between
+  passes survive, while code that only ran briefly goes first.*/
+static int block_clock_hand;
+
 void
-codegen_delete_random_block(int required_mem_block)
+codegen_delete_cold_block(int required_mem_block)
 {
-    int block_nr = rand() & BLOCK_MASK;
-
     while (1) {
-        if (block_nr && block_nr != block_current) {
-            codeblock_t *block = &codeblock[block_nr];
+        block_clock_hand = (block_clock_hand + 1) & BLOCK_MASK;
+
+        if (block_clock_hand && block_clock_hand != block_current) {
+            codeblock_t *block = &codeblock[block_clock_hand];
 
             if (block->pc != BLOCK_PC_INVALID && (!required_mem_block || block->head_mem_block)) {
-                delete_block(block);
-                return;
+                if (block->heat)
+                    block->heat--;
+                else {
+                    codegen_stats.block_evictions++;
+                    delete_block(block);
+                    return;
+                }
             }
         }
-        block_nr = (block_nr + 1) & BLOCK_MASK;
     }
 }
 
@@ -530,6 +639,8 @@ codegen_block_init(uint32_t phys_addr)
     block->page_mask = block->page_mask2 = 0;
     block->flags                         = CODEBLOCK_STATIC_TOP;
     block->status                        = cpu_cur_status;
+    block->heat                          = 0;
+    block->exec_count                    = 1;
 
     recomp_page = block->phys & ~0xfff;
     codeblock_tree_add(block);
@@ -559,6 +670,8 @@ codegen_block_start_recompile(codeblock_t *block)
         fatal("Recompile to used block!\n");
 #endif
 
+    if (block->head_mem_block)
+        codegen_allocator_free(block->head_mem_block);
     block->head_mem_block = codegen_allocator_allocate(NULL, block_current);
     block->data           = codeblock_allocator_get_ptr(block->head_mem_block);
 
@@ -592,8 +705,9 @@ codegen_block_start_recompile(codeblock_t *block)
     block->TOP = cpu_state.TOP & 7;
     block->flags |= CODEBLOCK_WAS_RECOMPILED;
 
-    codegen_flat_ds = !(cpu_cur_status & CPU_STATUS_NOTFLATDS);
-    codegen_flat_ss = !(cpu_cur_status & CPU_STATUS_NOTFLATSS);
+    codegen_flat_ds       = !(cpu_cur_status & CPU_STATUS_NOTFLATDS);
+    codegen_flat_ss       = !(cpu_cur_status & CPU_STATUS_NOTFLATSS);
+    codegen_default_mxcsr = !(cpu_cur_status & CPU_STATUS_NOTDEFMXCSR);
 
     if (block->flags & CODEBLOCK_BYTE_MASK) {
         block->dirty_mask  = &page->byte_dirty_mask[(block->phys >> PAGE_BYTE_MASK_SHIFT) & PAGE_BYTE_MASK_OFFSET_MASK];
@@ -607,6 +721,16 @@ codegen_block_start_recompile(codeblock_t *block)
     codegen_generate_reset();
 }
 
+/*Mark a compiled block as hot. It will be recompiled with more aggressive
+  optimisation the next time it is entered*/
+void
+codegen_block_mark_hot(codeblock_t *block)
+{
+    block->flags &= ~CODEBLOCK_WAS_RECOMPILED;
+    block->flags |= CODEBLOCK_TIER2;
+    codegen_stats.block_tier2++;
+}
+
 void
 codegen_block_remove(void)
 {
@@ -777,6 +901,8 @@ codegen_block_end_recompile(codeblock_t *block)
 
     codegen_accumulate_flush(ir_data);
     codegen_ir_compile(ir_data, block);
+
+    codegen_hint_cache_add(block);
 }
 
 void
@@ -0,0 +1,222 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <86box/86box.h>
+#include "cpu.h"
+#include <86box/mem.h>
+#include <86box/nvr.h>
+#include <86box/plat.h>
+
+#include "codegen.h"
+#include "codegen_hint_cache.h"
+
+/*Compile hint cache. This records which blocks were recompiled on a previous
+  run, so that on the next run they can be recompiled the first time they are
+  seen instead of going through the 'mark, then recompile' pass. No generated
+  code is stored - every block is still translated from scratch on each run,
+  only the decision to translate it (and the flags to translate it with) is
+  carried over.
+
+  Entries are keyed on a hash of the code bytes at the start of the block, the
+  offset of the block within its page, and the CPU status the block was
+  compiled for. The file is only used if it was written for the same CPU and
+  FPU configuration. Since an entry only decides when a block is recompiled,
+  and the recompiler always works from the current contents of guest memory, a
+  stale or colliding entry can not cause incorrect code to be run. The usual
+  dirty mask checks catch any later modification of the code.*/
+
+#define CACHE_SIZE     0x10000
+#define CACHE_MASK     (CACHE_SIZE - 1)
+#define CACHE_PROBE    8
+/*Number of bytes hashed - the rest of the 64 byte granule the block starts in,
+  and the following granule*/
+#define CACHE_WINDOW   128
+
+#define CACHE_MAGIC    0x43524438 /*'8DRC'*/
+#define CACHE_VERSION  1
+#define CACHE_FILENAME "dynarec_hints.bin"
+
+/*Flags learnt from self-modifying code that are carried over to the next run*/
+#define CACHE_BLOCK_FLAGS (CODEBLOCK_BYTE_MASK | CODEBLOCK_NO_IMMEDIATES)
+
+typedef struct codegen_hint_cache_entry_t {
+    uint64_t hash;
+    uint16_t offset;
+    uint16_t status;
+    uint16_t flags;
+    uint16_t valid;
+} codegen_hint_cache_entry_t;
+
+typedef struct codegen_hint_cache_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t cpu_type;
+    uint32_t fpu_type;
+    uint32_t fpu_softfloat;
+    uint32_t nr_entries;
+} codegen_hint_cache_header_t;
+
+int codegen_hint_cache_enabled = 0;
+
+static codegen_hint_cache_entry_t cache[CACHE_SIZE];
+
+static uint64_t
+cache_hash_code(uint32_t phys_addr)
+{
+    const uint8_t *p    = _mem_exec[phys_addr >> MEM_GRANULARITY_BITS];
+    uint32_t       end  = (phys_addr & ~63) + CACHE_WINDOW;
+    uint64_t       hash = 0xcbf29ce484222325ULL;
+
+    if (!p)
+        return 0;
+    if ((end ^ phys_addr) & ~0xfff)
+        end = (phys_addr | 0xfff) + 1;
+
+    /*FNV-1a*/
+    for (uint32_t addr = phys_addr; addr != end; addr++) {
+        hash ^= p[addr & MEM_GRANULARITY_MASK];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash ? hash : 1;
+}
+
+static inline int
+cache_slot(uint64_t hash, uint32_t offset, uint16_t status)
+{
+    uint64_t key = hash ^ ((uint64_t) offset << 16) ^ status;
+
+    return (int) ((key ^ (key >> 29)) & CACHE_MASK);
+}
+
+static void
+cache_insert(uint64_t hash, uint16_t offset, uint16_t status, uint16_t flags)
+{
+    int index = cache_slot(hash, offset, status);
+
+    for (int c = 0; c < CACHE_PROBE; c++) {
+        codegen_hint_cache_entry_t *entry = &cache[(index + c) & CACHE_MASK];
+
+        if (!entry->valid || (entry->hash == hash && entry->offset == offset && entry->status == status)) {
+            entry->hash   = hash;
+            entry->offset = offset;
+            entry->status = status;
+            entry->flags |= flags;
+            entry->valid  = 1;
+            return;
+        }
+    }
+
+    /*No free entry in the probe sequence, replace the first one*/
+    cache[index].hash   = hash;
+    cache[index].offset = offset;
+    cache[index].status = status;
+    cache[index].flags  = flags;
+    cache[index].valid  = 1;
+}
+
+int
+codegen_hint_cache_lookup(uint32_t phys_addr, uint16_t status)
+{
+    uint64_t hash   = cache_hash_code(phys_addr);
+    uint16_t offset = phys_addr & 0xfff;
+    int      index;
+
+    if (!hash)
+        return -1;
+
+    index = cache_slot(hash, offset, status);
+    for (int c = 0; c < CACHE_PROBE; c++) {
+        codegen_hint_cache_entry_t *entry = &cache[(index + c) & CACHE_MASK];
+
+        if (!entry->valid)
+            break;
+        if (entry->hash == hash && entry->offset == offset && entry->status == status)
+            return entry->flags;
+    }
+
+    return -1;
+}
+
+void
+codegen_hint_cache_add(codeblock_t *block)
+{
+    uint64_t hash;
+
+    if (!codegen_hint_cache_enabled)
+        return;
+
+    hash = cache_hash_code(block->phys);
+    if (hash)
+        cache_insert(hash, block->phys & 0xfff, block->status, block->flags & CACHE_BLOCK_FLAGS);
+}
+
+static void
+cache_get_header(codegen_hint_cache_header_t *header)
+{
+    memset(header, 0, sizeof(codegen_hint_cache_header_t));
+    header->magic         = CACHE_MAGIC;
+    header->version       = CACHE_VERSION;
+    header->cpu_type      = cpu_s->cpu_type;
+    header->fpu_type      = fpu_type;
+    header->fpu_softfloat = fpu_softfloat;
+}
+
+void
+codegen_hint_cache_load(void)
+{
+    codegen_hint_cache_header_t header;
+    codegen_hint_cache_header_t file_header;
+    codegen_hint_cache_entry_t  entry;
+    FILE                  *fp;
+
+    memset(cache, 0, sizeof(cache));
+
+    codegen_hint_cache_enabled = cpu_use_dynarec && cpu_dynarec_hint_cache;
+    if (!codegen_hint_cache_enabled)
+        return;
+
+    fp = plat_fopen(nvr_path(CACHE_FILENAME), "rb");
+    if (fp == NULL)
+        return;
+
+    cache_get_header(&header);
+    if ((fread(&file_header, 1, sizeof(file_header), fp) == sizeof(file_header)) && (file_header.magic == header.magic) && (file_header.version == header.version) && (file_header.cpu_type == header.cpu_type) && (file_header.fpu_type == header.fpu_type) && (file_header.fpu_softfloat == header.fpu_softfloat)) {
+        for (uint32_t c = 0; c < file_header.nr_entries; c++) {
+            if (fread(&entry, 1, sizeof(entry), fp) != sizeof(entry))
+                break;
+            cache_insert(entry.hash, entry.offset, entry.status, entry.flags & CACHE_BLOCK_FLAGS);
+        }
+    }
+
+    fclose(fp);
+}
+
+void
+codegen_hint_cache_save(void)
+{
+    codegen_hint_cache_header_t header;
+    FILE                  *fp;
+
+    if (!codegen_hint_cache_enabled)
+        return;
+
+    fp = plat_fopen(nvr_path(CACHE_FILENAME), "wb");
+    if (fp == NULL)
+        return;
+
+    cache_get_header(&header);
+    for (int c = 0; c < CACHE_SIZE; c++) {
+        if (cache[c].valid)
+            header.nr_entries++;
+    }
+
+    fwrite(&header, 1, sizeof(header), fp);
+    for (int c = 0; c < CACHE_SIZE; c++) {
+        if (cache[c].valid)
+            fwrite(&cache[c], 1, sizeof(codegen_hint_cache_entry_t), fp);
+    }
+
+    fclose(fp);
+}
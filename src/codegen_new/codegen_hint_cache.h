@@ -0,0 +1,12 @@
+#ifndef _CODEGEN_HINT_CACHE_H_
+#define _CODEGEN_HINT_CACHE_H_
+
+extern int codegen_hint_cache_enabled;
+
+/*Look up the block starting at phys_addr in the compile hint cache.
+  Returns the codeblock flags to compile it with, or -1 if it is not present*/
+int  codegen_hint_cache_lookup(uint32_t phys_addr, uint16_t status);
+/*Record a recompiled block in the compile hint cache*/
+void codegen_hint_cache_add(codeblock_t *block);
+
+#endif
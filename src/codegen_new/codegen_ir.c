@@ -1,4 +1,7 @@
+#include <stdarg.h>
 #include <stdint.h>
+#include <string.h>
+#define HAVE_STDARG_H
 #include <86box/86box.h>
 #include "cpu.h"
 #include <86box/mem.h>
@@ -13,6 +16,43 @@
 extern int       has_ea;
 static ir_data_t ir_block;
 
+#ifdef ENABLE_CODEGEN_IR_LOG
+int codegen_ir_do_log = ENABLE_CODEGEN_IR_LOG;
+
+static void
+codegen_ir_log(const char *fmt, ...)
+{
+    va_list ap;
+
+    if (codegen_ir_do_log) {
+        va_start(ap, fmt);
+        pclog_ex(fmt, ap);
+        va_end(ap);
+    }
+}
+#else
+#    define codegen_ir_log(fmt, ...)
+#endif
+
+/*Value tracking for the optimisation passes. Each register version written in
+  the current epoch records either the constant it holds, or the register
+  version it is a copy of. A new epoch starts at every barrier (called code may
+  change any register in memory) and at every jump and jump destination (code
+  between the two is conditional), and values recorded in earlier epochs are
+  not trusted.*/
+typedef struct ir_value_t {
+    uint32_t epoch;
+    uint32_t imm_data;
+    uint8_t  is_const;
+    uint8_t  reg;
+    uint8_t  version;
+} ir_value_t;
+
+static ir_value_t ir_values[IREG_COUNT][256];
+static uint8_t    ir_jump_dest[UOP_NR_MAX + 1];
+static uint32_t   ir_epoch;
+static int        ir_static_top;
+
 static int codegen_unroll_start;
 static int codegen_unroll_count;
 static int codegen_unroll_first_instruction;
@@ -59,6 +99,496 @@ duplicate_uop(ir_data_t *ir, uop_t *uop, int offset)
     }
 }
 
+static int
+ir_count_uops(const ir_data_t *ir)
+{
+    int count = 0;
+
+    for (int c = 0; c < ir->wr_pos; c++) {
+        if ((ir->uops[c].type & UOP_MASK) != UOP_INVALID)
+            count++;
+    }
+
+    return count;
+}
+
+static inline int
+ir_reg_is_native_l(ir_reg_t ir_reg)
+{
+    return !ir_reg_is_invalid(ir_reg) && IREG_GET_SIZE(ir_reg.reg) == IREG_SIZE_L && reg_is_native_size(ir_reg);
+}
+
+/*Returns non-zero if values written to ir_reg can be tracked. This is any
+  native 32-bit register, plus the FPU tags when TOP is static - each IR tag
+  register is then always the same physical tag, so a tag written once in an
+  epoch (eg by a run of FADDs to ST(0)) is known to hold that value.*/
+static inline int
+ir_reg_is_tracked(ir_reg_t ir_reg)
+{
+    if (ir_reg_is_native_l(ir_reg))
+        return 1;
+
+    return ir_static_top && !ir_reg_is_invalid(ir_reg) && IREG_GET_REG(ir_reg.reg) >= IREG_tag0 && IREG_GET_REG(ir_reg.reg) <= IREG_tag7 && reg_is_native_size(ir_reg);
+}
+
+/*Drop a read of ir_reg, and queue the version for removal if nothing needs it*/
+static void
+ir_reg_release(ir_reg_t ir_reg)
+{
+    reg_version_t *regv = &reg_version[IREG_GET_REG(ir_reg.reg)][ir_reg.version];
+
+    regv->refcount--;
+    if (!regv->refcount && !(regv->flags & (REG_FLAGS_REQUIRED | REG_FLAGS_DEAD)))
+        add_to_dead_list(regv, IREG_GET_REG(ir_reg.reg), ir_reg.version);
+}
+
+static void
+ir_value_start(ir_data_t *ir)
+{
+    memset(ir_jump_dest, 0, sizeof(ir_jump_dest));
+    for (int c = 0; c < ir->wr_pos; c++) {
+        if ((ir->uops[c].type & UOP_TYPE_JUMP) && ir->uops[c].jump_dest_uop != -1)
+            ir_jump_dest[ir->uops[c].jump_dest_uop] = 1;
+    }
+
+    ir_epoch++;
+}
+
+static inline void
+ir_value_check_epoch(const uop_t *uop, int c)
+{
+    if ((uop->type & (UOP_TYPE_BARRIER | UOP_TYPE_JUMP)) || ir_jump_dest[c])
+        ir_epoch++;
+}
+
+static void
+ir_value_read(ir_reg_t ir_reg, ir_value_t *value)
+{
+    const ir_value_t *reg_value = &ir_values[IREG_GET_REG(ir_reg.reg)][ir_reg.version];
+
+    if (ir_reg.version && reg_value->epoch == ir_epoch && ir_reg_is_tracked(ir_reg))
+        *value = *reg_value;
+    else {
+        value->epoch    = ir_epoch;
+        value->is_const = 0;
+        value->reg      = IREG_GET_REG(ir_reg.reg);
+        value->version  = ir_reg.version;
+    }
+}
+
+static inline void
+ir_value_set_const(ir_value_t *value, uint32_t imm_data)
+{
+    value->epoch    = ir_epoch;
+    value->is_const = 1;
+    value->imm_data = imm_data;
+}
+
+static inline int
+ir_value_equal(const ir_value_t *a, const ir_value_t *b)
+{
+    if (a->is_const || b->is_const)
+        return a->is_const && b->is_const && a->imm_data == b->imm_data;
+
+    return a->reg == b->reg && a->version == b->version;
+}
+
+/*Record the value written to the destination of uop. value may be NULL if
+  nothing is known about it*/
+static void
+ir_value_write(const uop_t *uop, const ir_value_t *value)
+{
+    ir_value_t *reg_value = &ir_values[IREG_GET_REG(uop->dest_reg_a.reg)][uop->dest_reg_a.version];
+
+    if (value && ir_reg_is_tracked(uop->dest_reg_a))
+        *reg_value = *value;
+    else {
+        reg_value->epoch    = ir_epoch;
+        reg_value->is_const = 0;
+        reg_value->reg      = IREG_GET_REG(uop->dest_reg_a.reg);
+        reg_value->version  = uop->dest_reg_a.version;
+    }
+}
+
+static void
+ir_uop_set_mov_imm(uop_t *uop, uint32_t imm_data)
+{
+    if (!ir_reg_is_invalid(uop->src_reg_a))
+        ir_reg_release(uop->src_reg_a);
+    if (!ir_reg_is_invalid(uop->src_reg_b))
+        ir_reg_release(uop->src_reg_b);
+    if (!ir_reg_is_invalid(uop->src_reg_c))
+        ir_reg_release(uop->src_reg_c);
+
+    uop->type      = UOP_MOV_IMM;
+    uop->src_reg_a = invalid_ir_reg;
+    uop->src_reg_b = invalid_ir_reg;
+    uop->src_reg_c = invalid_ir_reg;
+    uop->imm_data  = imm_data;
+}
+
+/*Convert a two register uOP into the immediate form, taking the immediate from
+  source b*/
+static void
+ir_uop_set_imm_b(uop_t *uop, uint32_t type, uint32_t imm_data)
+{
+    ir_reg_release(uop->src_reg_b);
+
+    uop->type      = type;
+    uop->src_reg_b = invalid_ir_reg;
+    uop->imm_data  = imm_data;
+}
+
+/*As above, but taking the immediate from source a. Only valid for commutative
+  operations*/
+static void
+ir_uop_set_imm_a(uop_t *uop, uint32_t type, uint32_t imm_data)
+{
+    ir_reg_release(uop->src_reg_a);
+
+    uop->type      = type;
+    uop->src_reg_a = uop->src_reg_b;
+    uop->src_reg_b = invalid_ir_reg;
+    uop->imm_data  = imm_data;
+}
+
+static int
+ir_fold_imm(uint32_t type, uint32_t a, uint32_t b, uint32_t *result)
+{
+    switch (type) {
+        case UOP_ADD:
+        case UOP_ADD_IMM:
+            *result = a + b;
+            return 1;
+        case UOP_SUB:
+        case UOP_SUB_IMM:
+            *result = a - b;
+            return 1;
+        case UOP_AND:
+        case UOP_AND_IMM:
+            *result = a & b;
+            return 1;
+        case UOP_OR:
+        case UOP_OR_IMM:
+            *result = a | b;
+            return 1;
+        case UOP_XOR:
+        case UOP_XOR_IMM:
+            *result = a ^ b;
+            return 1;
+        case UOP_SHL:
+        case UOP_SHL_IMM:
+            if (b > 31)
+                return 0;
+            *result = a << b;
+            return 1;
+        case UOP_SHR:
+        case UOP_SHR_IMM:
+            if (b > 31)
+                return 0;
+            *result = a >> b;
+            return 1;
+        case UOP_SAR:
+        case UOP_SAR_IMM:
+            if (b > 31)
+                return 0;
+            *result = (uint32_t) ((int32_t) a >> b);
+            return 1;
+
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static uint32_t
+ir_imm_type(uint32_t type)
+{
+    switch (type) {
+        case UOP_ADD:
+            return UOP_ADD_IMM;
+        case UOP_SUB:
+            return UOP_SUB_IMM;
+        case UOP_AND:
+            return UOP_AND_IMM;
+        case UOP_OR:
+            return UOP_OR_IMM;
+        case UOP_XOR:
+            return UOP_XOR_IMM;
+        case UOP_SHL:
+            return UOP_SHL_IMM;
+        case UOP_SHR:
+            return UOP_SHR_IMM;
+        case UOP_SAR:
+            return UOP_SAR_IMM;
+
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+/*Constant folding and propagation. 32-bit ALU uOPs with constant sources are
+  replaced with UOP_MOV_IMM or the immediate form of the uOP. Source versions
+  that are no longer read are queued for removal.*/
+static void
+ir_pass_const_fold(ir_data_t *ir)
+{
+    ir_value_start(ir);
+
+    for (int c = 0; c < ir->wr_pos; c++) {
+        uop_t     *uop = &ir->uops[c];
+        ir_value_t src_a;
+        ir_value_t src_b;
+        ir_value_t value;
+        uint32_t   result;
+        uint32_t   imm_type;
+
+        ir_value_check_epoch(uop, c);
+
+        if ((uop->type & UOP_MASK) == UOP_INVALID || ir_reg_is_invalid(uop->dest_reg_a))
+            continue;
+        if (!ir_reg_is_native_l(uop->dest_reg_a) || (uop->type & (UOP_TYPE_BARRIER | UOP_TYPE_ORDER_BARRIER))) {
+            ir_value_write(uop, NULL);
+            continue;
+        }
+
+        switch (uop->type) {
+            case UOP_MOV_IMM:
+                ir_value_set_const(&value, uop->imm_data);
+                ir_value_write(uop, &value);
+                continue;
+
+            case UOP_MOV:
+                if (!ir_reg_is_native_l(uop->src_reg_a))
+                    break;
+                ir_value_read(uop->src_reg_a, &value);
+                if (value.is_const)
+                    ir_uop_set_mov_imm(uop, value.imm_data);
+                ir_value_write(uop, &value);
+                continue;
+
+            case UOP_ADD_IMM:
+            case UOP_SUB_IMM:
+            case UOP_AND_IMM:
+            case UOP_OR_IMM:
+            case UOP_XOR_IMM:
+            case UOP_SHL_IMM:
+            case UOP_SHR_IMM:
+            case UOP_SAR_IMM:
+                if (!ir_reg_is_native_l(uop->src_reg_a))
+                    break;
+                ir_value_read(uop->src_reg_a, &src_a);
+                if (src_a.is_const && ir_fold_imm(uop->type, src_a.imm_data, uop->imm_data, &result)) {
+                    ir_uop_set_mov_imm(uop, result);
+                    ir_value_set_const(&value, result);
+                    ir_value_write(uop, &value);
+                    continue;
+                }
+                break;
+
+            case UOP_ADD:
+            case UOP_SUB:
+            case UOP_AND:
+            case UOP_OR:
+            case UOP_XOR:
+            case UOP_SHL:
+            case UOP_SHR:
+            case UOP_SAR:
+                if (!ir_reg_is_native_l(uop->src_reg_a) || !ir_reg_is_native_l(uop->src_reg_b))
+                    break;
+                ir_value_read(uop->src_reg_a, &src_a);
+                ir_value_read(uop->src_reg_b, &src_b);
+                imm_type = ir_imm_type(uop->type);
+                if (src_a.is_const && src_b.is_const && ir_fold_imm(uop->type, src_a.imm_data, src_b.imm_data, &result)) {
+                    ir_uop_set_mov_imm(uop, result);
+                    ir_value_set_const(&value, result);
+                    ir_value_write(uop, &value);
+                    continue;
+                }
+                if (src_b.is_const && (src_b.imm_data < 32 || (uop->type != UOP_SHL && uop->type != UOP_SHR && uop->type != UOP_SAR)))
+                    ir_uop_set_imm_b(uop, imm_type, src_b.imm_data);
+                else if (src_a.is_const && (uop->type == UOP_ADD || uop->type == UOP_AND || uop->type == UOP_OR || uop->type == UOP_XOR))
+                    ir_uop_set_imm_a(uop, imm_type, src_a.imm_data);
+                break;
+
+            default:
+                break;
+        }
+
+        ir_value_write(uop, NULL);
+    }
+
+    codegen_reg_process_dead_list(ir);
+}
+
+/*Count a read of reg.version, and redirect it to the previous version if
+  rewrite is set*/
+static int
+ir_redirect_read(ir_reg_t *src_reg, int reg, int version, int rewrite)
+{
+    if (ir_reg_is_invalid(*src_reg) || IREG_GET_REG(src_reg->reg) != reg || src_reg->version != version)
+        return 0;
+
+    if (rewrite)
+        src_reg->version = version - 1;
+    return 1;
+}
+
+/*Remove the write of a register version that is known to hold the same value
+  as the version before it. All reads of the removed version are redirected to
+  the previous version. Returns 1 if the write was removed.*/
+static int
+ir_remove_write(ir_data_t *ir, int uop_nr)
+{
+    uop_t         *uop       = &ir->uops[uop_nr];
+    int            reg       = IREG_GET_REG(uop->dest_reg_a.reg);
+    int            version   = uop->dest_reg_a.version;
+    reg_version_t *regv      = &reg_version[reg][version];
+    reg_version_t *prev_regv = &reg_version[reg][version - 1];
+    int            end       = ir->wr_pos;
+    int            nr_reads  = 0;
+
+    if (prev_regv->flags & REG_FLAGS_DEAD)
+        return 0;
+    if (prev_regv->refcount + regv->refcount > REG_REFCOUNT_MAX)
+        return 0;
+    if (version < reg_last_version[reg]) {
+        const reg_version_t *next_regv = &reg_version[reg][version + 1];
+
+        /*A partial write of the next version implicitly reads this one*/
+        if (!reg_is_native_size(ir->uops[next_regv->parent_uop].dest_reg_a))
+            return 0;
+        end = next_regv->parent_uop + 1;
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int c = uop_nr + 1; c < end; c++) {
+            uop_t *uop_read = &ir->uops[c];
+
+            if ((uop_read->type & UOP_MASK) == UOP_INVALID)
+                continue;
+
+            nr_reads += ir_redirect_read(&uop_read->src_reg_a, reg, version, pass);
+            nr_reads += ir_redirect_read(&uop_read->src_reg_b, reg, version, pass);
+            nr_reads += ir_redirect_read(&uop_read->src_reg_c, reg, version, pass);
+        }
+
+        /*Only rewrite the IR if all the reads have been accounted for*/
+        if (!pass && nr_reads != regv->refcount)
+            return 0;
+    }
+
+    prev_regv->refcount += regv->refcount;
+    prev_regv->flags |= (regv->flags & REG_FLAGS_REQUIRED);
+    regv->refcount = 0;
+    regv->flags |= REG_FLAGS_DEAD;
+
+    if (!ir_reg_is_invalid(uop->src_reg_a))
+        ir_reg_release(uop->src_reg_a);
+    uop->type = UOP_INVALID;
+
+    return 1;
+}
+
+/*Redundant register write removal. A UOP_MOV_IMM or UOP_MOV that writes a
+  register with the value it already holds is removed, along with the load or
+  store that would otherwise be generated for it.*/
+static void
+ir_pass_redundant_writes(ir_data_t *ir)
+{
+    ir_value_start(ir);
+
+    for (int c = 0; c < ir->wr_pos; c++) {
+        uop_t     *uop = &ir->uops[c];
+        ir_value_t value;
+        ir_value_t prev_value;
+        ir_reg_t   prev_reg;
+
+        ir_value_check_epoch(uop, c);
+
+        if ((uop->type & UOP_MASK) == UOP_INVALID || ir_reg_is_invalid(uop->dest_reg_a))
+            continue;
+
+        if (uop->type == UOP_MOV_IMM && ir_reg_is_tracked(uop->dest_reg_a))
+            ir_value_set_const(&value, uop->imm_data);
+        else if (uop->type == UOP_MOV && ir_reg_is_tracked(uop->dest_reg_a) && ir_reg_is_tracked(uop->src_reg_a))
+            ir_value_read(uop->src_reg_a, &value);
+        else {
+            ir_value_write(uop, NULL);
+            continue;
+        }
+
+        prev_reg         = uop->dest_reg_a;
+        prev_reg.version = uop->dest_reg_a.version - 1;
+        ir_value_read(prev_reg, &prev_value);
+        if (ir_value_equal(&value, &prev_value) && ir_remove_write(ir, c))
+            continue;
+
+        ir_value_write(uop, &value);
+    }
+
+    codegen_reg_process_dead_list(ir);
+}
+
+/*Dead flag elimination. Versions of the lazy flags registers that are not
+  live - never read, and overwritten before the next barrier - are removed,
+  along with the uOPs that only compute them.*/
+static void
+ir_pass_dead_flags(ir_data_t *ir)
+{
+    static const int flags_regs[] = { IREG_flags_op, IREG_flags_res, IREG_flags_op1, IREG_flags_op2 };
+
+    for (uint8_t c = 0; c < (sizeof(flags_regs) / sizeof(flags_regs[0])); c++) {
+        int reg = flags_regs[c];
+
+        for (int version = 1; version <= reg_last_version[reg]; version++) {
+            reg_version_t *regv = &reg_version[reg][version];
+
+            if (!regv->refcount && !(regv->flags & (REG_FLAGS_REQUIRED | REG_FLAGS_DEAD)))
+                add_to_dead_list(regv, reg, version);
+        }
+    }
+
+    codegen_reg_process_dead_list(ir);
+}
+
+typedef struct ir_pass_t {
+    const char *name;
+    void (*pass)(ir_data_t *ir);
+} ir_pass_t;
+
+static const ir_pass_t ir_passes[] = {
+    {"constant folding",  ir_pass_const_fold      },
+    { "redundant writes", ir_pass_redundant_writes},
+    { "dead flags",       ir_pass_dead_flags      }
+};
+
+/*Run the optimisation passes over the IR, before register allocation*/
+static void
+codegen_ir_optimise(ir_data_t *ir, codeblock_t *block)
+{
+    int uops_in = ir_count_uops(ir);
+    int uops    = uops_in;
+
+    ir_static_top = (block->flags & CODEBLOCK_STATIC_TOP) ? 1 : 0;
+
+    for (uint8_t c = 0; c < (sizeof(ir_passes) / sizeof(ir_passes[0])); c++) {
+        int uops_pass;
+
+        ir_passes[c].pass(ir);
+
+        uops_pass = ir_count_uops(ir);
+        codegen_ir_log("IR %08x: %-16s %4i -> %4i uOPs\n", block->pc, ir_passes[c].name, uops, uops_pass);
+        uops = uops_pass;
+    }
+
+    codegen_stats.ir_uops_in += uops_in;
+    codegen_stats.ir_uops_out += uops;
+}
+
 void
 codegen_ir_compile(ir_data_t *ir, codeblock_t *block)
 {
@@ -82,7 +612,9 @@ codegen_ir_compile(ir_data_t *ir, codeblock_t *block)
     }
 
     codegen_reg_mark_as_required();
+    codegen_reg_mark_live(ir);
     codegen_reg_process_dead_list(ir);
+    codegen_ir_optimise(ir, block);
     block_write_data = codeblock_allocator_get_ptr(block->head_mem_block);
     block_pos        = 0;
     codegen_backend_prologue(block);
@@ -108,7 +640,7 @@ codegen_ir_compile(ir_data_t *ir, codeblock_t *block)
             continue;
 
 #ifdef CODEGEN_BACKEND_HAS_MOV_IMM
-        if ((uop->type & UOP_MASK) == (UOP_MOV_IMM & UOP_MASK) && reg_is_native_size(uop->dest_reg_a) && !codegen_reg_is_loaded(uop->dest_reg_a) && reg_version[IREG_GET_REG(uop->dest_reg_a.reg)][uop->dest_reg_a.version].refcount <= 0) {
+        if ((uop->type & UOP_MASK) == (UOP_MOV_IMM & UOP_MASK) && codegen_reg_can_write_imm(block, uop->dest_reg_a) && !codegen_reg_is_loaded(uop->dest_reg_a) && reg_version[IREG_GET_REG(uop->dest_reg_a.reg)][uop->dest_reg_a.version].refcount <= 0) {
             /*Special case for UOP_MOV_IMM - if destination not already in host register
               and won't be used again then just store directly to memory*/
             codegen_reg_write_imm(block, uop->dest_reg_a, uop->imm_data);
@@ -324,7 +324,18 @@
 /*UOP_PFRSQRT - (packed float) dest_reg[0] = dest_reg[1] = 1.0 / sqrt(src_reg[0])*/
 #define UOP_PFRSQRT (UOP_TYPE_PARAMS_REGS | 0xc5)
 
-#define UOP_MAX     0xc6
+/*UOP_DIVPS - (packed float) dest_reg = src_reg_a / src_reg_b*/
+#define UOP_DIVPS (UOP_TYPE_PARAMS_REGS | 0xc6)
+/*UOP_SQRTPS - (packed float) dest_reg = sqrt(src_reg)*/
+#define UOP_SQRTPS (UOP_TYPE_PARAMS_REGS | 0xc7)
+/*UOP_MAXPS - (packed float) dest_reg = (src_reg_a > src_reg_b) ? src_reg_a : src_reg_b
+  Unlike UOP_PFMAX, src_reg_b is returned if either operand is NaN, as SSE MAXPS does*/
+#define UOP_MAXPS (UOP_TYPE_PARAMS_REGS | 0xc8)
+/*UOP_MINPS - (packed float) dest_reg = (src_reg_a < src_reg_b) ? src_reg_a : src_reg_b
+  Unlike UOP_PFMIN, src_reg_b is returned if either operand is NaN, as SSE MINPS does*/
+#define UOP_MINPS (UOP_TYPE_PARAMS_REGS | 0xc9)
+
+#define UOP_MAX     0xca
 
 #define UOP_INVALID 0xff
 
@@ -776,6 +787,11 @@ uop_gen_reg_src2_pointer(uint32_t uop_type, ir_data_t *ir, int src_reg_a, int sr
 #define uop_PFSUB(ir, dst_reg, src_reg_a, src_reg_b)                     uop_gen_reg_dst_src2(UOP_PFSUB, ir, dst_reg, src_reg_a, src_reg_b)
 #define uop_PI2FD(ir, dst_reg, src_reg)                                  uop_gen_reg_dst_src1(UOP_PI2FD, ir, dst_reg, src_reg)
 
+#define uop_DIVPS(ir, dst_reg, src_reg_a, src_reg_b)                     uop_gen_reg_dst_src2(UOP_DIVPS, ir, dst_reg, src_reg_a, src_reg_b)
+#define uop_MAXPS(ir, dst_reg, src_reg_a, src_reg_b)                     uop_gen_reg_dst_src2(UOP_MAXPS, ir, dst_reg, src_reg_a, src_reg_b)
+#define uop_MINPS(ir, dst_reg, src_reg_a, src_reg_b)                     uop_gen_reg_dst_src2(UOP_MINPS, ir, dst_reg, src_reg_a, src_reg_b)
+#define uop_SQRTPS(ir, dst_reg, src_reg)                                 uop_gen_reg_dst_src1(UOP_SQRTPS, ir, dst_reg, src_reg)
+
 #define uop_PMADDWD(ir, dst_reg, src_reg_a, src_reg_b)                   uop_gen_reg_dst_src2(UOP_PMADDWD, ir, dst_reg, src_reg_a, src_reg_b)
 #define uop_PMULHW(ir, dst_reg, src_reg_a, src_reg_b)                    uop_gen_reg_dst_src2(UOP_PMULHW, ir, dst_reg, src_reg_a, src_reg_b)
 #define uop_PMULLW(ir, dst_reg, src_reg_a, src_reg_b)                    uop_gen_reg_dst_src2(UOP_PMULLW, ir, dst_reg, src_reg_a, src_reg_b)
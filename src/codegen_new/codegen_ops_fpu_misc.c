@@ -24,7 +24,7 @@ ropFFREE(UNUSED(codeblock_t *block), ir_data_t *ir, UNUSED(uint8_t opcode), uint
     int dest_reg = fetchdat & 7;
 
     uop_FP_ENTER(ir);
-    uop_MOV(ir, IREG_tag(dest_reg), TAG_EMPTY);
+    uop_MOV_IMM(ir, IREG_tag(dest_reg), TAG_EMPTY);
 
     return op_pc;
 }
@@ -114,13 +114,13 @@ ropFXCH(UNUSED(codeblock_t *block), ir_data_t *ir, UNUSED(uint8_t opcode), uint3
     uop_FP_ENTER(ir);
     uop_MOV(ir, IREG_temp0_D, IREG_ST(0));
     uop_MOV(ir, IREG_temp1_Q, IREG_ST_i64(0));
-    uop_MOV(ir, IREG_temp2, IREG_tag(0));
+    uop_MOV(ir, IREG_temp2_B, IREG_tag(0));
     uop_MOV(ir, IREG_ST(0), IREG_ST(dest_reg));
     uop_MOV(ir, IREG_ST_i64(0), IREG_ST_i64(dest_reg));
     uop_MOV(ir, IREG_tag(0), IREG_tag(dest_reg));
     uop_MOV(ir, IREG_ST(dest_reg), IREG_temp0_D);
     uop_MOV(ir, IREG_ST_i64(dest_reg), IREG_temp1_Q);
-    uop_MOV(ir, IREG_tag(dest_reg), IREG_temp2);
+    uop_MOV(ir, IREG_tag(dest_reg), IREG_temp2_B);
 
     return op_pc;
 }
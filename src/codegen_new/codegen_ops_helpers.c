@@ -38,6 +38,9 @@ LOAD_IMMEDIATE_FROM_RAM_32_unaligned(UNUSED(codeblock_t *block), ir_data_t *ir,
 #define UNROLL_MAX_REG_REFERENCES 200
 #define UNROLL_MAX_UOPS           1000
 #define UNROLL_MAX_COUNT          10
+/*Hot blocks are allowed more iterations, still within the uOP and register
+  reference limits above*/
+#define UNROLL_MAX_COUNT_TIER2    32
 int
 codegen_can_unroll_full(codeblock_t *block, ir_data_t *ir, UNUSED(uint32_t next_pc), uint32_t dest_addr)
 {
@@ -66,7 +69,10 @@ codegen_can_unroll_full(codeblock_t *block, ir_data_t *ir, UNUSED(uint32_t next_
     max_unroll = UNROLL_MAX_UOPS / ((ir->wr_pos - start) + 6);
     if ((max_version_refcount != 0) && (max_unroll > (UNROLL_MAX_REG_REFERENCES / max_version_refcount)))
         max_unroll = (UNROLL_MAX_REG_REFERENCES / max_version_refcount);
-    if (max_unroll > UNROLL_MAX_COUNT)
+    if (block->flags & CODEBLOCK_TIER2) {
+        if (max_unroll > UNROLL_MAX_COUNT_TIER2)
+            max_unroll = UNROLL_MAX_COUNT_TIER2;
+    } else if (max_unroll > UNROLL_MAX_COUNT)
         max_unroll = UNROLL_MAX_COUNT;
     if (max_unroll <= 1)
         return 0;
@@ -125,3 +125,20 @@ codegen_can_unroll(codeblock_t *block, ir_data_t *ir, uint32_t next_pc, uint32_t
 
     return codegen_can_unroll_full(block, ir, next_pc, dest_addr);
 }
+
+/*SSE instructions are only recompiled when the CPU supports them and there is
+  no operand size prefix (the 66-prefixed forms are SSE2 encodings)*/
+static inline int
+codegen_sse_valid(uint32_t op_32)
+{
+    return (cpu_features & CPU_FEATURE_SSE) && !((op_32 ^ use32) & 0x100);
+}
+
+/*Recompiled SSE arithmetic runs with the host's default rounding mode and all
+  exceptions masked, so it is only valid when the guest MXCSR control bits are at
+  their defaults, both when the block was entered and at this instruction*/
+static inline int
+codegen_sse_default_mxcsr(void)
+{
+    return codegen_default_mxcsr && !(cpu_cur_status & CPU_STATUS_NOTDEFMXCSR);
+}
@@ -0,0 +1,84 @@
+#include <stdint.h>
+#include <86box/86box.h>
+#include "cpu.h"
+#include <86box/mem.h>
+#include <86box/plat_unused.h>
+
+#include "x86.h"
+#include "x86_flags.h"
+#include "x86seg_common.h"
+#include "x86seg.h"
+#include "386_common.h"
+#include "codegen.h"
+#include "codegen_accumulate.h"
+#include "codegen_ir.h"
+#include "codegen_ops.h"
+#include "codegen_ops_sse_arith.h"
+#include "codegen_ops_helpers.h"
+
+/*ADDPS, SUBPS and MULPS have the same semantics as the 3DNow! uOPs when run with
+  the host's default rounding mode*/
+#define ropPSarith(func, uop)                                                                      \
+    uint32_t rop##func(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode),                  \
+                       uint32_t fetchdat, uint32_t op_32, uint32_t op_pc)                          \
+    {                                                                                              \
+        int dest_reg = (fetchdat >> 3) & 7;                                                        \
+                                                                                                   \
+        if (!codegen_sse_valid(op_32) || !codegen_sse_default_mxcsr())                             \
+            return 0;                                                                              \
+                                                                                                   \
+        codegen_mark_code_present(block, cs + op_pc, 1);                                           \
+        if ((fetchdat & 0xc0) == 0xc0) {                                                           \
+            int src_reg = fetchdat & 7;                                                            \
+            uop_##uop(ir, IREG_XMM_L(dest_reg), IREG_XMM_L(dest_reg), IREG_XMM_L(src_reg));        \
+            uop_##uop(ir, IREG_XMM_H(dest_reg), IREG_XMM_H(dest_reg), IREG_XMM_H(src_reg));        \
+        } else {                                                                                   \
+            x86seg *target_seg;                                                                    \
+                                                                                                   \
+            uop_MOV_IMM(ir, IREG_oldpc, cpu_state.oldpc);                                          \
+            target_seg = codegen_generate_ea(ir, op_ea_seg, fetchdat, op_ssegs, &op_pc, op_32, 0); \
+            codegen_check_seg_read(block, ir, target_seg);                                         \
+            uop_MEM_LOAD_REG(ir, IREG_temp0_Q, ireg_seg_base(target_seg), IREG_eaaddr);            \
+            uop_MEM_LOAD_REG_OFFSET(ir, IREG_temp1_Q, ireg_seg_base(target_seg), IREG_eaaddr, 8);  \
+            uop_##uop(ir, IREG_XMM_L(dest_reg), IREG_XMM_L(dest_reg), IREG_temp0_Q);               \
+            uop_##uop(ir, IREG_XMM_H(dest_reg), IREG_XMM_H(dest_reg), IREG_temp1_Q);               \
+        }                                                                                          \
+                                                                                                   \
+        return op_pc + 1;                                                                          \
+    }
+
+// clang-format off
+ropPSarith(ADDPS, PFADD)
+ropPSarith(DIVPS, DIVPS)
+ropPSarith(MAXPS, MAXPS)
+ropPSarith(MINPS, MINPS)
+ropPSarith(MULPS, PFMUL)
+ropPSarith(SUBPS, PFSUB)
+    // clang-format on
+
+uint32_t ropSQRTPS(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), uint32_t fetchdat, uint32_t op_32, uint32_t op_pc)
+{
+    int dest_reg = (fetchdat >> 3) & 7;
+
+    if (!codegen_sse_valid(op_32) || !codegen_sse_default_mxcsr())
+        return 0;
+
+    codegen_mark_code_present(block, cs + op_pc, 1);
+    if ((fetchdat & 0xc0) == 0xc0) {
+        int src_reg = fetchdat & 7;
+        uop_SQRTPS(ir, IREG_XMM_L(dest_reg), IREG_XMM_L(src_reg));
+        uop_SQRTPS(ir, IREG_XMM_H(dest_reg), IREG_XMM_H(src_reg));
+    } else {
+        x86seg *target_seg;
+
+        uop_MOV_IMM(ir, IREG_oldpc, cpu_state.oldpc);
+        target_seg = codegen_generate_ea(ir, op_ea_seg, fetchdat, op_ssegs, &op_pc, op_32, 0);
+        codegen_check_seg_read(block, ir, target_seg);
+        uop_MEM_LOAD_REG(ir, IREG_temp0_Q, ireg_seg_base(target_seg), IREG_eaaddr);
+        uop_MEM_LOAD_REG_OFFSET(ir, IREG_temp1_Q, ireg_seg_base(target_seg), IREG_eaaddr, 8);
+        uop_SQRTPS(ir, IREG_XMM_L(dest_reg), IREG_temp0_Q);
+        uop_SQRTPS(ir, IREG_XMM_H(dest_reg), IREG_temp1_Q);
+    }
+
+    return op_pc + 1;
+}
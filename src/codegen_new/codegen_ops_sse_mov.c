@@ -0,0 +1,110 @@
+#include <stdint.h>
+#include <86box/86box.h>
+#include "cpu.h"
+#include <86box/mem.h>
+#include <86box/plat_unused.h>
+
+#include "x86.h"
+#include "x86_flags.h"
+#include "x86seg_common.h"
+#include "x86seg.h"
+#include "386_common.h"
+#include "codegen.h"
+#include "codegen_accumulate.h"
+#include "codegen_ir.h"
+#include "codegen_ops.h"
+#include "codegen_ops_sse_mov.h"
+#include "codegen_ops_helpers.h"
+
+static void
+CHECK_SSE_ALIGNMENT(ir_data_t *ir)
+{
+    int jump_uop;
+
+    uop_AND_IMM(ir, IREG_temp3, IREG_eaaddr, 0xf);
+    jump_uop = uop_CMP_IMM_JZ_DEST(ir, IREG_temp3, 0);
+    uop_JMP(ir, codegen_gpf_rout);
+    uop_set_jump_dest(ir, jump_uop);
+}
+
+static uint32_t
+ropMOVxPS_r_q(codeblock_t *block, ir_data_t *ir, uint32_t fetchdat, uint32_t op_32, uint32_t op_pc, int aligned)
+{
+    int dest_reg = (fetchdat >> 3) & 7;
+
+    if (!codegen_sse_valid(op_32))
+        return 0;
+
+    codegen_mark_code_present(block, cs + op_pc, 1);
+    if ((fetchdat & 0xc0) == 0xc0) {
+        int src_reg = fetchdat & 7;
+        uop_MOV(ir, IREG_XMM_L(dest_reg), IREG_XMM_L(src_reg));
+        uop_MOV(ir, IREG_XMM_H(dest_reg), IREG_XMM_H(src_reg));
+    } else {
+        x86seg *target_seg;
+
+        uop_MOV_IMM(ir, IREG_oldpc, cpu_state.oldpc);
+        target_seg = codegen_generate_ea(ir, op_ea_seg, fetchdat, op_ssegs, &op_pc, op_32, 0);
+        codegen_check_seg_read(block, ir, target_seg);
+        if (aligned)
+            CHECK_SSE_ALIGNMENT(ir);
+        /*Load both halves before writing either, so a fault on the second
+          half leaves the register unmodified*/
+        uop_MEM_LOAD_REG(ir, IREG_temp0_Q, ireg_seg_base(target_seg), IREG_eaaddr);
+        uop_MEM_LOAD_REG_OFFSET(ir, IREG_temp1_Q, ireg_seg_base(target_seg), IREG_eaaddr, 8);
+        uop_MOV(ir, IREG_XMM_L(dest_reg), IREG_temp0_Q);
+        uop_MOV(ir, IREG_XMM_H(dest_reg), IREG_temp1_Q);
+    }
+
+    return op_pc + 1;
+}
+static uint32_t
+ropMOVxPS_q_r(codeblock_t *block, ir_data_t *ir, uint32_t fetchdat, uint32_t op_32, uint32_t op_pc, int aligned)
+{
+    int src_reg = (fetchdat >> 3) & 7;
+
+    if (!codegen_sse_valid(op_32))
+        return 0;
+
+    codegen_mark_code_present(block, cs + op_pc, 1);
+    if ((fetchdat & 0xc0) == 0xc0) {
+        int dest_reg = fetchdat & 7;
+        uop_MOV(ir, IREG_XMM_L(dest_reg), IREG_XMM_L(src_reg));
+        uop_MOV(ir, IREG_XMM_H(dest_reg), IREG_XMM_H(src_reg));
+    } else {
+        x86seg *target_seg;
+
+        uop_MOV_IMM(ir, IREG_oldpc, cpu_state.oldpc);
+        target_seg = codegen_generate_ea(ir, op_ea_seg, fetchdat, op_ssegs, &op_pc, op_32, 0);
+        codegen_check_seg_write(block, ir, target_seg);
+        if (aligned)
+            CHECK_SSE_ALIGNMENT(ir);
+        CHECK_SEG_LIMITS(block, ir, target_seg, IREG_eaaddr, 15);
+        uop_MEM_STORE_REG(ir, ireg_seg_base(target_seg), IREG_eaaddr, IREG_XMM_L(src_reg));
+        uop_MEM_STORE_REG_OFFSET(ir, ireg_seg_base(target_seg), IREG_eaaddr, 8, IREG_XMM_H(src_reg));
+    }
+
+    return op_pc + 1;
+}
+
+uint32_t
+ropMOVUPS_r_q(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), uint32_t fetchdat, uint32_t op_32, uint32_t op_pc)
+{
+    return ropMOVxPS_r_q(block, ir, fetchdat, op_32, op_pc, 0);
+}
+uint32_t
+ropMOVUPS_q_r(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), uint32_t fetchdat, uint32_t op_32, uint32_t op_pc)
+{
+    return ropMOVxPS_q_r(block, ir, fetchdat, op_32, op_pc, 0);
+}
+
+uint32_t
+ropMOVAPS_r_q(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), uint32_t fetchdat, uint32_t op_32, uint32_t op_pc)
+{
+    return ropMOVxPS_r_q(block, ir, fetchdat, op_32, op_pc, 1);
+}
+uint32_t
+ropMOVAPS_q_r(codeblock_t *block, ir_data_t *ir, UNUSED(uint8_t opcode), uint32_t fetchdat, uint32_t op_32, uint32_t op_pc)
+{
+    return ropMOVxPS_q_r(block, ir, fetchdat, op_32, op_pc, 1);
+}
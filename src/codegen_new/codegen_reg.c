@@ -4,6 +4,8 @@
 #include <86box/mem.h>
 #include <86box/plat_unused.h>
 
+#include "x86.h"
+#include "x86_flags.h"
 #include "codegen.h"
 #include "codegen_backend.h"
 #include "codegen_ir_defs.h"
@@ -172,6 +174,24 @@ struct
     [IREG_eaa16] = { REG_WORD,         &cpu_state.eaaddr,                  REG_INTEGER, REG_PERMANENT},
     [IREG_x87_op] = { REG_WORD,         &x87_op,                            REG_INTEGER, REG_PERMANENT},
 
+    [IREG_XMM0_lx] = { REG_QWORD,         &XMM[0].q[0],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM1_lx] = { REG_QWORD,         &XMM[1].q[0],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM2_lx] = { REG_QWORD,         &XMM[2].q[0],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM3_lx] = { REG_QWORD,         &XMM[3].q[0],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM4_lx] = { REG_QWORD,         &XMM[4].q[0],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM5_lx] = { REG_QWORD,         &XMM[5].q[0],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM6_lx] = { REG_QWORD,         &XMM[6].q[0],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM7_lx] = { REG_QWORD,         &XMM[7].q[0],                       REG_FP,      REG_PERMANENT},
+
+    [IREG_XMM0_hx] = { REG_QWORD,         &XMM[0].q[1],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM1_hx] = { REG_QWORD,         &XMM[1].q[1],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM2_hx] = { REG_QWORD,         &XMM[2].q[1],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM3_hx] = { REG_QWORD,         &XMM[3].q[1],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM4_hx] = { REG_QWORD,         &XMM[4].q[1],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM5_hx] = { REG_QWORD,         &XMM[5].q[1],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM6_hx] = { REG_QWORD,         &XMM[6].q[1],                       REG_FP,      REG_PERMANENT},
+    [IREG_XMM7_hx] = { REG_QWORD,         &XMM[7].q[1],                       REG_FP,      REG_PERMANENT},
+
  /*Temporary registers are stored on the stack, and are not guaranteed to
   be preserved across uOPs. They will not be written back if they will
   not be read again.*/
@@ -195,6 +215,109 @@ codegen_reg_mark_as_required(void)
     }
 }
 
+/*Returns non-zero if the lazy flags mode in flags_op needs flags_op1 and
+  flags_op2 to evaluate the flags*/
+static int
+flags_op_uses_operands(uint32_t flags_op)
+{
+    switch (flags_op) {
+        case FLAGS_ZN8:
+        case FLAGS_ZN16:
+        case FLAGS_ZN32:
+        case FLAGS_ROL8:
+        case FLAGS_ROL16:
+        case FLAGS_ROL32:
+        case FLAGS_ROR8:
+        case FLAGS_ROR16:
+        case FLAGS_ROR32:
+            return 0;
+
+        default:
+            break;
+    }
+
+    return 1;
+}
+
+/*Mark every register version that can be observed from outside the IR as
+  required, so that it is never optimised out, replacing the conservative
+  marking done while the IR was generated. This must be called once the IR is
+  complete, as codegen_reg_read() clears the flags of the version it reads.
+
+  A version is observable if it is the value on block entry, if it is the
+  last version of a permanent register, if a barrier falls between it being
+  written and the next version being written (the barrier will write it back),
+  or if the next version is a partial write that merges with it. As in
+  codegen_reg_write(), EAX-EBX are never optimised out.
+
+  flags_op1 and flags_op2 are only ever read through the lazy flags functions,
+  which look at flags_op first. In a block with no internal jumps, a barrier
+  or the block exit only observes them if the flags_op value at that point
+  uses them. This is what lets the operands of eg an ADD that is followed by
+  an AND be dropped, rather than written back at the end of the block for a
+  successor that will never look at them.*/
+void
+codegen_reg_mark_live(ir_data_t *ir)
+{
+    static uint16_t barrier_count[UOP_NR_MAX + 1];
+    static uint16_t flags_barrier_count[UOP_NR_MAX + 1];
+    int             has_jumps      = 0;
+    int             flags_op_known = 0;
+    int             flags_at_exit;
+
+    /*Conditional code makes the flags_op value at any given point uncertain,
+      so don't try*/
+    for (int c = 0; c < ir->wr_pos; c++) {
+        if (ir->uops[c].type & UOP_TYPE_JUMP) {
+            has_jumps = 1;
+            break;
+        }
+    }
+
+    barrier_count[0]       = 0;
+    flags_barrier_count[0] = 0;
+    for (int c = 0; c < ir->wr_pos; c++) {
+        const uop_t *uop        = &ir->uops[c];
+        int          is_barrier = (uop->type & (UOP_TYPE_BARRIER | UOP_TYPE_ORDER_BARRIER)) ? 1 : 0;
+
+        barrier_count[c + 1]       = barrier_count[c] + is_barrier;
+        flags_barrier_count[c + 1] = flags_barrier_count[c] + ((is_barrier && (has_jumps || !flags_op_known)) ? 1 : 0);
+
+        /*Called code may change flags_op*/
+        if (uop->type & UOP_TYPE_BARRIER)
+            flags_op_known = 0;
+        if (!ir_reg_is_invalid(uop->dest_reg_a) && IREG_GET_REG(uop->dest_reg_a.reg) == IREG_flags_op)
+            flags_op_known = (uop->type == UOP_MOV_IMM && !flags_op_uses_operands(uop->imm_data));
+    }
+    flags_at_exit = has_jumps || !flags_op_known;
+
+    for (int reg = 0; reg < IREG_COUNT; reg++) {
+        int       last_version = reg_last_version[reg];
+        uint16_t *count        = (reg == IREG_flags_op1 || reg == IREG_flags_op2) ? flags_barrier_count : barrier_count;
+
+        reg_version[reg][0].flags |= REG_FLAGS_REQUIRED;
+
+        for (int version = 1; version <= last_version; version++) {
+            reg_version_t *regv = &reg_version[reg][version];
+
+            regv->flags &= ~REG_FLAGS_REQUIRED;
+            if (version == last_version) {
+                if (ireg_data[reg].is_volatile == REG_PERMANENT) {
+                    if (count == barrier_count || flags_at_exit || count[ir->wr_pos] != count[regv->parent_uop + 1])
+                        regv->flags |= REG_FLAGS_REQUIRED;
+                }
+            } else {
+                const reg_version_t *next_regv = &reg_version[reg][version + 1];
+
+                if (!reg_is_native_size(ir->uops[next_regv->parent_uop].dest_reg_a))
+                    regv->flags |= REG_FLAGS_REQUIRED;
+                else if (ireg_data[reg].is_volatile == REG_PERMANENT && (reg <= IREG_EBX || count[next_regv->parent_uop + 1] != count[regv->parent_uop + 1]))
+                    regv->flags |= REG_FLAGS_REQUIRED;
+            }
+        }
+    }
+}
+
 int
 reg_is_native_size(ir_reg_t ir_reg)
 {
@@ -503,6 +626,19 @@ codegen_reg_writeback(host_reg_set_t *reg_set, codeblock_t *block, int c, int in
 }
 
 #ifdef CODEGEN_BACKEND_HAS_MOV_IMM
+/*Returns non-zero if an immediate can be stored directly to the memory backing
+  ir_reg. FPU tags can only be addressed directly when TOP is static*/
+int
+codegen_reg_can_write_imm(codeblock_t *block, ir_reg_t ir_reg)
+{
+    if (!reg_is_native_size(ir_reg))
+        return 0;
+    if (ireg_data[IREG_GET_REG(ir_reg.reg)].native_size == REG_FPU_ST_BYTE)
+        return (block->flags & CODEBLOCK_STATIC_TOP) ? 1 : 0;
+
+    return 1;
+}
+
 void
 codegen_reg_write_imm(codeblock_t *block, ir_reg_t ir_reg, uint32_t imm_data)
 {
@@ -533,10 +669,17 @@ codegen_reg_write_imm(codeblock_t *block, ir_reg_t ir_reg, uint32_t imm_data)
                 codegen_direct_write_32_imm(block, p, imm_data);
             break;
 
+        case REG_FPU_ST_BYTE:
+#    ifndef RELEASE_BUILD
+            if (!(block->flags & CODEBLOCK_STATIC_TOP))
+                fatal("codegen_reg_write_imm - REG_FPU_ST_BYTE !CODEBLOCK_STATIC_TOP\n");
+#    endif
+            codegen_direct_write_8_imm(block, &cpu_state.tag[ir_reg.reg & 7], imm_data);
+            break;
+
         case REG_POINTER:
         case REG_QWORD:
         case REG_DOUBLE:
-        case REG_FPU_ST_BYTE:
         case REG_FPU_ST_QWORD:
         case REG_FPU_ST_DOUBLE:
         default:
@@ -882,19 +1025,19 @@ codegen_reg_process_dead_list(ir_data_t *ir)
             if (uop->src_reg_a.reg != IREG_INVALID) {
                 reg_version_t *src_regv = &reg_version[IREG_GET_REG(uop->src_reg_a.reg)][uop->src_reg_a.version];
                 src_regv->refcount--;
-                if (!src_regv->refcount)
+                if (!src_regv->refcount && !(src_regv->flags & REG_FLAGS_REQUIRED))
                     add_to_dead_list(src_regv, IREG_GET_REG(uop->src_reg_a.reg), uop->src_reg_a.version);
             }
             if (uop->src_reg_b.reg != IREG_INVALID) {
                 reg_version_t *src_regv = &reg_version[IREG_GET_REG(uop->src_reg_b.reg)][uop->src_reg_b.version];
                 src_regv->refcount--;
-                if (!src_regv->refcount)
+                if (!src_regv->refcount && !(src_regv->flags & REG_FLAGS_REQUIRED))
                     add_to_dead_list(src_regv, IREG_GET_REG(uop->src_reg_b.reg), uop->src_reg_b.version);
             }
             if (uop->src_reg_c.reg != IREG_INVALID) {
                 reg_version_t *src_regv = &reg_version[IREG_GET_REG(uop->src_reg_c.reg)][uop->src_reg_c.version];
                 src_regv->refcount--;
-                if (!src_regv->refcount)
+                if (!src_regv->refcount && !(src_regv->flags & REG_FLAGS_REQUIRED))
                     add_to_dead_list(src_regv, IREG_GET_REG(uop->src_reg_c.reg), uop->src_reg_c.version);
             }
             regv->flags |= REG_FLAGS_DEAD;
@@ -75,7 +75,9 @@ enum {
       When CODEBLOCK_STATIC_TOP is set, the physical register number will be
       used directly to index the stack. When it is clear, the difference
       between the current value of TOP and the value when the block was
-      first compiled will be added to adjust for any changes in TOP.*/
+      first compiled will be added to adjust for any changes in TOP.
+      Tags are accessed at their native (byte) size, so writing one does not
+      have to load the previous value first.*/
     IREG_ST0 = 40,
     IREG_ST1 = 41,
     IREG_ST2 = 42,
@@ -135,7 +137,26 @@ enum {
     IREG_eaa16 = 88,
     IREG_x87_op = 89,
 
-    IREG_COUNT = 90,
+    /*SSE registers are split into two 64-bit halves*/
+    IREG_XMM0_lx = 90,
+    IREG_XMM1_lx = 91,
+    IREG_XMM2_lx = 92,
+    IREG_XMM3_lx = 93,
+    IREG_XMM4_lx = 94,
+    IREG_XMM5_lx = 95,
+    IREG_XMM6_lx = 96,
+    IREG_XMM7_lx = 97,
+
+    IREG_XMM0_hx = 98,
+    IREG_XMM1_hx = 99,
+    IREG_XMM2_hx = 100,
+    IREG_XMM3_hx = 101,
+    IREG_XMM4_hx = 102,
+    IREG_XMM5_hx = 103,
+    IREG_XMM6_hx = 104,
+    IREG_XMM7_hx = 105,
+
+    IREG_COUNT = 106,
 
     IREG_INVALID = 255,
 
@@ -200,6 +221,24 @@ enum {
     IREG_MM6 = IREG_MM6x + IREG_SIZE_Q,
     IREG_MM7 = IREG_MM7x + IREG_SIZE_Q,
 
+    IREG_XMM0_l = IREG_XMM0_lx + IREG_SIZE_Q,
+    IREG_XMM1_l = IREG_XMM1_lx + IREG_SIZE_Q,
+    IREG_XMM2_l = IREG_XMM2_lx + IREG_SIZE_Q,
+    IREG_XMM3_l = IREG_XMM3_lx + IREG_SIZE_Q,
+    IREG_XMM4_l = IREG_XMM4_lx + IREG_SIZE_Q,
+    IREG_XMM5_l = IREG_XMM5_lx + IREG_SIZE_Q,
+    IREG_XMM6_l = IREG_XMM6_lx + IREG_SIZE_Q,
+    IREG_XMM7_l = IREG_XMM7_lx + IREG_SIZE_Q,
+
+    IREG_XMM0_h = IREG_XMM0_hx + IREG_SIZE_Q,
+    IREG_XMM1_h = IREG_XMM1_hx + IREG_SIZE_Q,
+    IREG_XMM2_h = IREG_XMM2_hx + IREG_SIZE_Q,
+    IREG_XMM3_h = IREG_XMM3_hx + IREG_SIZE_Q,
+    IREG_XMM4_h = IREG_XMM4_hx + IREG_SIZE_Q,
+    IREG_XMM5_h = IREG_XMM5_hx + IREG_SIZE_Q,
+    IREG_XMM6_h = IREG_XMM6_hx + IREG_SIZE_Q,
+    IREG_XMM7_h = IREG_XMM7_hx + IREG_SIZE_Q,
+
     IREG_NPXC = IREG_NPXCx + IREG_SIZE_W,
     IREG_NPXS = IREG_NPXSx + IREG_SIZE_W,
 
@@ -215,11 +254,13 @@ enum {
 
 #define IREG_ST(r)                 (IREG_ST0 + ((cpu_state.TOP + (r)) & 7) + IREG_SIZE_D)
 #define IREG_ST_i64(r)             (IREG_ST0_i64 + ((cpu_state.TOP + (r)) & 7) + IREG_SIZE_Q)
-#define IREG_tag(r)                (IREG_tag0 + ((cpu_state.TOP + (r)) & 7))
-#define IREG_tag_B(r)              (IREG_tag0 + ((cpu_state.TOP + (r)) & 7) + IREG_SIZE_B)
+#define IREG_tag(r)                (IREG_tag0 + ((cpu_state.TOP + (r)) & 7) + IREG_SIZE_B)
 
 #define IREG_MM(reg)               ((reg) + IREG_MM0)
 
+#define IREG_XMM_L(reg)            ((reg) + IREG_XMM0_l)
+#define IREG_XMM_H(reg)            ((reg) + IREG_XMM0_h)
+
 #define IREG_TOP_diff_stack_offset 32
 
 static inline int
@@ -415,6 +456,7 @@ void codegen_reg_alloc_register(ir_reg_t dest_reg_a, ir_reg_t src_reg_a, ir_reg_
 
 #ifdef CODEGEN_BACKEND_HAS_MOV_IMM
 int  codegen_reg_is_loaded(ir_reg_t ir_reg);
+int  codegen_reg_can_write_imm(codeblock_t *block, ir_reg_t ir_reg);
 void codegen_reg_write_imm(codeblock_t *block, ir_reg_t ir_reg, uint32_t imm_data);
 #endif
 
@@ -424,5 +466,6 @@ ir_host_reg_t codegen_reg_alloc_write_reg(codeblock_t *block, ir_reg_t ir_reg);
 void codegen_reg_rename(codeblock_t *block, ir_reg_t src, ir_reg_t dst);
 
 void codegen_reg_mark_as_required(void);
+void codegen_reg_mark_live(struct ir_data_t *ir);
 void codegen_reg_process_dead_list(struct ir_data_t *ir);
 #endif
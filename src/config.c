@@ -391,9 +391,30 @@ load_machine(void)
         mem_size = machine_get_max_ram(machine);
 
     cpu_use_dynarec = !!ini_section_get_int(cat, "cpu_use_dynarec", 0);
+    cpu_dynarec_hint_cache = !!ini_section_get_int(cat, "cpu_dynarec_hint_cache", 0);
+    cpu_dynarec_threshold = ini_section_get_int(cat, "cpu_dynarec_threshold", 1);
+    if (cpu_dynarec_threshold < 1)
+        cpu_dynarec_threshold = 1;
+    else if (cpu_dynarec_threshold > 0xffff)
+        cpu_dynarec_threshold = 0xffff;
+    cpu_dynarec_hot_threshold = ini_section_get_int(cat, "cpu_dynarec_hot_threshold", 0);
+    if (cpu_dynarec_hot_threshold < 0)
+        cpu_dynarec_hot_threshold = 0;
+    else if (cpu_dynarec_hot_threshold > 0xffff)
+        cpu_dynarec_hot_threshold = 0xffff;
+    if (cpu_dynarec_hot_threshold && (cpu_dynarec_hot_threshold < cpu_dynarec_threshold))
+        cpu_dynarec_hot_threshold = cpu_dynarec_threshold;
+    cpu_808x_fast = !!ini_section_get_int(cat, "cpu_808x_fast", 0);
+    cpu_tlb_size = ini_section_get_int(cat, "cpu_tlb_size", 0);
+    if (cpu_tlb_size < 0)
+        cpu_tlb_size = 0;
+    mem_ksm = !!ini_section_get_int(cat, "mem_ksm", 0);
+    rivatimer_emulated = !!ini_section_get_int(cat, "rivatimer_emulated", 0);
+    cpu_hlt_skip = !!ini_section_get_int(cat, "cpu_hlt_skip", 1);
     fpu_softfloat = !!ini_section_get_int(cat, "fpu_softfloat", 0);
     if ((fpu_type != FPU_NONE) && machine_has_flags(machine, MACHINE_SOFTFLOAT_ONLY))
         fpu_softfloat = 1;
+    fpu_softfloat_fast = !!ini_section_get_int(cat, "fpu_softfloat_fast", 0);
 
     p = ini_section_get_string(cat, "time_sync", NULL);
     if (p != NULL) {
@@ -732,6 +753,16 @@ load_network(void)
                                              (NET_LINK_10_HD | NET_LINK_10_FD |
                                               NET_LINK_100_HD | NET_LINK_100_FD |
                                               NET_LINK_1000_HD | NET_LINK_1000_FD));
+
+        sprintf(temp, "net_%02i_queue_len", c + 1);
+        nc->queue_len = ini_section_get_int(cat, temp, NET_QUEUE_LEN);
+        if (nc->queue_len < NET_QUEUE_LEN_MIN)
+            nc->queue_len = NET_QUEUE_LEN_MIN;
+        else if (nc->queue_len > NET_QUEUE_LEN_MAX)
+            nc->queue_len = NET_QUEUE_LEN_MAX;
+        /* Round down to a power of 2. */
+        while (nc->queue_len & (nc->queue_len - 1))
+            nc->queue_len &= nc->queue_len - 1;
     }
 }
 
@@ -2172,11 +2203,56 @@ save_machine(void)
 
     ini_section_set_int(cat, "cpu_use_dynarec", cpu_use_dynarec);
 
+    if (cpu_dynarec_hint_cache == 0)
+        ini_section_delete_var(cat, "cpu_dynarec_hint_cache");
+    else
+        ini_section_set_int(cat, "cpu_dynarec_hint_cache", cpu_dynarec_hint_cache);
+
+    if (cpu_dynarec_threshold == 1)
+        ini_section_delete_var(cat, "cpu_dynarec_threshold");
+    else
+        ini_section_set_int(cat, "cpu_dynarec_threshold", cpu_dynarec_threshold);
+
+    if (cpu_dynarec_hot_threshold == 0)
+        ini_section_delete_var(cat, "cpu_dynarec_hot_threshold");
+    else
+        ini_section_set_int(cat, "cpu_dynarec_hot_threshold", cpu_dynarec_hot_threshold);
+
+    if (cpu_808x_fast == 0)
+        ini_section_delete_var(cat, "cpu_808x_fast");
+    else
+        ini_section_set_int(cat, "cpu_808x_fast", cpu_808x_fast);
+
+    if (cpu_tlb_size == 0)
+        ini_section_delete_var(cat, "cpu_tlb_size");
+    else
+        ini_section_set_int(cat, "cpu_tlb_size", cpu_tlb_size);
+
+    if (mem_ksm == 0)
+        ini_section_delete_var(cat, "mem_ksm");
+    else
+        ini_section_set_int(cat, "mem_ksm", mem_ksm);
+
+    if (rivatimer_emulated == 0)
+        ini_section_delete_var(cat, "rivatimer_emulated");
+    else
+        ini_section_set_int(cat, "rivatimer_emulated", rivatimer_emulated);
+
+    if (cpu_hlt_skip == 1)
+        ini_section_delete_var(cat, "cpu_hlt_skip");
+    else
+        ini_section_set_int(cat, "cpu_hlt_skip", cpu_hlt_skip);
+
     if (fpu_softfloat == 0)
         ini_section_delete_var(cat, "fpu_softfloat");
     else
         ini_section_set_int(cat, "fpu_softfloat", fpu_softfloat);
 
+    if (fpu_softfloat_fast == 0)
+        ini_section_delete_var(cat, "fpu_softfloat_fast");
+    else
+        ini_section_set_int(cat, "fpu_softfloat_fast", fpu_softfloat_fast);
+
     if (time_sync & TIME_SYNC_ENABLED)
         if (time_sync & TIME_SYNC_UTC)
             ini_section_set_string(cat, "time_sync", "utc");
@@ -2439,6 +2515,12 @@ save_network(void)
             ini_section_delete_var(cat, temp);
         else
             ini_section_set_int(cat, temp, nc->link_state);
+
+        sprintf(temp, "net_%02i_queue_len", c + 1);
+        if ((nc->queue_len == 0) || (nc->queue_len == NET_QUEUE_LEN))
+            ini_section_delete_var(cat, temp);
+        else
+            ini_section_set_int(cat, temp, nc->queue_len);
     }
 
     ini_delete_section_if_empty(config, cat);
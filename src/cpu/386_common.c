@@ -1489,6 +1489,42 @@ enter_smm_check(int in_hlt)
     }
 }
 
+/* Cycles to charge for a HLT that nothing is about to wake up. Until the next
+   timer deadline only a timer callback can raise an interrupt, so the halted
+   CPU can skip straight to it rather than re-executing the HLT every 100
+   cycles. The interpreters only leave their inner loop once the timer is
+   reached, so there the skip always goes all the way to it; any cycles past
+   the end of the slice are paid back by the next one, while the main loop
+   sleeps the host. 100 cycles remains the minimum, as before. */
+int32_t
+cpu_hlt_idle_cycles(void)
+{
+    int32_t idle;
+
+    if (!cpu_hlt_skip || trap || (nmi && nmi_enable && nmi_mask) || !timer_pending())
+        return 100;
+
+#ifdef USE_DYNAREC
+    if (cpu_exec == exec386_dynarec) {
+        /* The TSC is only brought up to date at the end of each block. */
+        update_tsc();
+        if (((cpu_state.flags & I_FLAG) && pic.int_pending) || !timer_pending())
+            return 100;
+    }
+#endif
+
+    idle = (int32_t) (timer_target - (uint32_t) tsc) + 1;
+
+#ifdef USE_DYNAREC
+    /* The dynarec counts the slice down in 5 us periods and can stop at the
+       end of it. */
+    if ((cpu_exec == exec386_dynarec) && (idle > cycles_main))
+        idle = cycles_main;
+#endif
+
+    return (idle > 100) ? idle : 100;
+}
+
 void
 leave_smm(void)
 {
@@ -2225,6 +2261,22 @@ nmi_raise(void)
     nmi = 1;
 }
 
+void
+cpu_set_mxcsr(uint32_t val)
+{
+    mxcsr = val;
+
+#ifdef USE_NEW_DYNAREC
+    if ((mxcsr & MXCSR_CONTROL_MASK) == MXCSR_CONTROL_DEFAULT)
+        cpu_cur_status &= ~CPU_STATUS_NOTDEFMXCSR;
+    else
+        cpu_cur_status |= CPU_STATUS_NOTDEFMXCSR;
+#endif
+#ifdef USE_DYNAREC
+    codegen_default_mxcsr = 0;
+#endif
+}
+
 #ifndef USE_DYNAREC
 /* This is for compatibility with new x87 code. */
 void
@@ -310,16 +310,43 @@ int checkio(uint32_t port, int mask);
     }
 
 #ifdef OPS_286_386
-/* TODO: Introduce functions to read exec. */
+/* Code fetches from the single page remembered by pccache_fill_2386() read RAM
+   directly, instructions are still decoded on every execution. The misalignment
+   penalties of readmemwl_2386() and readmemll_2386() still apply. */
+static __inline int
+pccache_hit_2386(uint32_t a)
+{
+    return (((a & ~0xfff) | CPL) == pccache_2386) && !(dr[7] & 0x000000ff);
+}
+
+static __inline uint16_t
+pccache_readw_2386(uint32_t a)
+{
+    if ((a & 1) && (!cpu_cyrix_alignment || (a & 7) == 7))
+        cycles -= timing_misaligned;
+    return *(uint16_t *) &pccache2_2386[a & 0xfff];
+}
+
+static __inline uint32_t
+pccache_readl_2386(uint32_t a)
+{
+    if ((a & 3) && (!cpu_cyrix_alignment || (a & 7) > 4))
+        cycles -= timing_misaligned;
+    return *(uint32_t *) &pccache2_2386[a & 0xfff];
+}
+
 static __inline uint8_t
 fastreadb(uint32_t a)
 {
     uint8_t ret;
+    if (pccache_hit_2386(a))
+        return cpu_state.abrt ? 0 : pccache2_2386[a & 0xfff];
     read_type = 1;
     ret = readmembl_2386(a);
     read_type = 4;
     if (cpu_state.abrt)
         return 0;
+    pccache_fill_2386(a, addr64);
     return ret;
 }
 
@@ -327,11 +354,15 @@ static __inline uint16_t
 fastreadw(uint32_t a)
 {
     uint16_t ret;
+    if (((a & 0xfff) <= 0xffe) && pccache_hit_2386(a))
+        return cpu_state.abrt ? 0 : pccache_readw_2386(a);
     read_type = 1;
     ret = readmemwl_2386(a);
     read_type = 4;
     if (cpu_state.abrt)
         return 0;
+    if ((a & 0xfff) <= 0xffe)
+        pccache_fill_2386(a, addr64a[0]);
     return ret;
 }
 
@@ -339,11 +370,15 @@ static __inline uint32_t
 fastreadl(uint32_t a)
 {
     uint32_t ret;
+    if (((a & 0xfff) <= 0xffc) && pccache_hit_2386(a))
+        return cpu_state.abrt ? 0 : pccache_readl_2386(a);
     read_type = 1;
     ret = readmemll_2386(a);
     read_type = 4;
     if (cpu_state.abrt)
         return 0;
+    if ((a & 0xfff) <= 0xffc)
+        pccache_fill_2386(a, addr64a[0]);
     return ret;
 }
 #else
@@ -478,10 +513,14 @@ fastreadw_fetch(uint32_t a)
             ret |= ((uint16_t) fastreadb(a + 1) << 8);
     } else if (cpu_state.abrt)
         ret = 0;
+    else if (pccache_hit_2386(a))
+        ret = pccache_readw_2386(a);
     else {
         read_type = 1;
         ret = readmemwl_2386(a);
         read_type = 4;
+        if (!cpu_state.abrt)
+            pccache_fill_2386(a, addr64a[0]);
     }
     cpu_old_paging = 0;
 
@@ -499,12 +538,16 @@ fastreadl_fetch(uint32_t a)
             ret |= ((uint32_t) fastreadw(a + 2) << 16);
     } else if (cpu_state.abrt)
         ret = 0;
+    else if (pccache_hit_2386(a))
+        ret = pccache_readl_2386(a);
     else {
         read_type = 1;
         cpu_old_paging = (cpu_flush_pending == 2);
         ret = readmemll_2386(a);
         cpu_old_paging = 0;
         read_type = 4;
+        if (!cpu_state.abrt)
+            pccache_fill_2386(a, addr64a[0]);
     }
 
     return ret;
@@ -37,6 +37,7 @@
 #    include "codegen.h"
 #    ifdef USE_NEW_DYNAREC
 #        include "codegen_backend.h"
+#        include "codegen_hint_cache.h"
 #    endif
 #endif
 
@@ -381,13 +382,33 @@ static __inline void
 #endif
 exec386_dynarec_dyn(void)
 {
-    uint32_t start_pc  = 0;
-    uint32_t phys_addr = get_phys(cs + cpu_state.pc);
-    int      hash      = HASH(phys_addr);
+    uint32_t start_pc = 0;
 #    ifdef USE_NEW_DYNAREC
-    codeblock_t *block = &codeblock[codeblock_hash[hash]];
+    codeblock_t *block      = NULL;
+    codeblock_t *prev_block = NULL;
+    int          linked     = 0;
+    uint32_t     phys_addr;
+    int          hash;
+
+    /* A block linked from the previous one had its translation and pages
+       validated when the link was made, and codeblock_link_find() only returns
+       it if the TLB has not been flushed since. It can then be entered without
+       translating the PC or looking it up again, only CS, the CPU state and the
+       page dirty masks need checking. */
+    if (codegen_block_last != BLOCK_INVALID) {
+        prev_block         = &codeblock[codegen_block_last];
+        codegen_block_last = BLOCK_INVALID;
+        block              = codeblock_link_find(prev_block, cs + cpu_state.pc);
+        linked             = block && (block->_cs == cs) && !((block->status ^ cpu_cur_status) & CPU_STATUS_FLAGS) && ((block->status & cpu_cur_status & CPU_STATUS_MASK) == (cpu_cur_status & CPU_STATUS_MASK));
+    }
+    phys_addr = linked ? block->phys : get_phys(cs + cpu_state.pc);
+    hash      = HASH(phys_addr);
+    if (!linked)
+        block = &codeblock[codeblock_hash[hash]];
 #    else
-    codeblock_t *block = codeblock_hash[hash];
+    uint32_t     phys_addr = get_phys(cs + cpu_state.pc);
+    int          hash      = HASH(phys_addr);
+    codeblock_t *block     = codeblock_hash[hash];
 #    endif
     int valid_block = 0;
 
@@ -402,7 +423,12 @@ exec386_dynarec_dyn(void)
         /* Block must match current CS, PC, code segment size,
            and physical address. The physical address check will
            also catch any page faults at this stage */
-        valid_block = (block->pc == cs + cpu_state.pc) && (block->_cs == cs) && (block->phys == phys_addr) && !((block->status ^ cpu_cur_status) & CPU_STATUS_FLAGS) && ((block->status & cpu_cur_status & CPU_STATUS_MASK) == (cpu_cur_status & CPU_STATUS_MASK));
+#    ifdef USE_NEW_DYNAREC
+        if (linked)
+            valid_block = 1;
+        else
+#    endif
+            valid_block = (block->pc == cs + cpu_state.pc) && (block->_cs == cs) && (block->phys == phys_addr) && !((block->status ^ cpu_cur_status) & CPU_STATUS_FLAGS) && ((block->status & cpu_cur_status & CPU_STATUS_MASK) == (cpu_cur_status & CPU_STATUS_MASK));
         if (!valid_block) {
             uint64_t mask = (uint64_t) 1 << ((phys_addr >> PAGE_MASK_SHIFT) & PAGE_MASK_MASK);
 #    ifdef USE_NEW_DYNAREC
@@ -452,7 +478,8 @@ exec386_dynarec_dyn(void)
                the page fault to occur when the page boundary
                is actually crossed.*/
 #    ifdef USE_NEW_DYNAREC
-            uint32_t phys_addr_2 = get_phys_noabrt(block->pc + ((block->flags & CODEBLOCK_BYTE_MASK) ? 0x40 : 0x400));
+            /* Unchanged since the link was made, if the block is linked. */
+            uint32_t phys_addr_2 = linked ? block->phys_2 : get_phys_noabrt(block->pc + ((block->flags & CODEBLOCK_BYTE_MASK) ? 0x40 : 0x400));
 #    else
             uint32_t phys_addr_2 = get_phys_noabrt(block->endpc);
 #    endif
@@ -476,7 +503,9 @@ exec386_dynarec_dyn(void)
             }
         }
 #    ifdef USE_NEW_DYNAREC
-        if (valid_block && (block->flags & CODEBLOCK_IN_DIRTY_LIST)) {
+        /* exec_count is cleared when a block is invalidated, so this
+           only happens on the first entry after self-modifying code. */
+        if (valid_block && (block->flags & CODEBLOCK_IN_DIRTY_LIST) && !block->exec_count) {
             block->flags &= ~CODEBLOCK_WAS_RECOMPILED;
             if (block->flags & CODEBLOCK_BYTE_MASK)
                 block->flags |= CODEBLOCK_NO_IMMEDIATES;
@@ -500,6 +529,24 @@ exec386_dynarec_dyn(void)
     }
 
 #    ifdef USE_NEW_DYNAREC
+    if (!valid_block && !cpu_state.abrt && codegen_hint_cache_enabled) {
+        /* This code was recompiled on a previous run, so skip the
+           mark pass and recompile it straight away. */
+        int cache_flags = codegen_hint_cache_lookup(phys_addr, cpu_cur_status);
+
+        if (cache_flags != -1) {
+            codegen_block_init(phys_addr);
+            block = &codeblock[block_current];
+            block->flags |= cache_flags;
+            block->exec_count = cpu_dynarec_threshold;
+            valid_block = 1;
+            codegen_stats.block_hint_hits++;
+        }
+    }
+
+    if (valid_block && (block->flags & CODEBLOCK_WAS_RECOMPILED) && cpu_dynarec_hot_threshold && !(block->flags & CODEBLOCK_TIER2) && (block->exec_count >= cpu_dynarec_hot_threshold))
+        codegen_block_mark_hot(block);
+
     if (valid_block && (block->flags & CODEBLOCK_WAS_RECOMPILED))
 #    else
     if (valid_block && block->was_recompiled)
@@ -509,6 +556,18 @@ exec386_dynarec_dyn(void)
 
 #    ifndef USE_NEW_DYNAREC
         codeblock_hash[hash] = block;
+#    else
+        if (block->heat < CODEBLOCK_HEAT_MAX)
+            block->heat++;
+        if (block->exec_count < CODEBLOCK_EXEC_COUNT_MAX)
+            block->exec_count++;
+        if (linked)
+            codegen_stats.block_linked++;
+        else {
+            codegen_stats.block_dispatched++;
+            if (prev_block)
+                codegen_block_link(prev_block, block);
+        }
 #    endif
         inrecomp = 1;
         code();
@@ -517,12 +576,26 @@ exec386_dynarec_dyn(void)
 #    endif
         inrecomp = 0;
 
+#    ifdef USE_NEW_DYNAREC
+        if (!cpu_state.abrt && (block->flags & CODEBLOCK_WAS_RECOMPILED) && (block->pc != BLOCK_PC_INVALID))
+            codegen_block_last = get_block_nr(block);
+#    endif
+
 #    ifndef USE_NEW_DYNAREC
         if (!use32)
             cpu_state.pc &= 0xffff;
+#    endif
+#    ifdef USE_NEW_DYNAREC
+    } else if (valid_block && !cpu_state.abrt && (cpu_dynarec_threshold > 1) && (block->exec_count < cpu_dynarec_threshold)) {
+        /* Block has not been run often enough yet to be worth recompiling,
+           keep interpreting it. The mark pass counts as the first run. */
+        block->exec_count++;
+        codegen_stats.block_interpreted++;
+        exec386_dynarec_int();
 #    endif
     } else if (valid_block && !cpu_state.abrt) {
 #    ifdef USE_NEW_DYNAREC
+        codegen_stats.block_misses++;
         start_pc                 = cs + cpu_state.pc;
         const int max_block_size = (block->flags & CODEBLOCK_BYTE_MASK) ? ((128 - 25) - (start_pc & 0x3f)) : 1000;
 #    else
@@ -634,6 +707,7 @@ exec386_dynarec_dyn(void)
     } else if (!cpu_state.abrt) {
         /* Mark block but do not recompile */
 #    ifdef USE_NEW_DYNAREC
+        codegen_stats.block_misses++;
         start_pc                 = cs + cpu_state.pc;
         const int max_block_size = (block->flags & CODEBLOCK_BYTE_MASK) ? ((128 - 25) - (start_pc & 0x3f)) : 1000;
 #    else
@@ -745,7 +819,10 @@ exec386_dynarec(int32_t cycs)
     uint64_t oldtsc;
     uint64_t delta;
 
-    int32_t cyc_period = cycs / 2000; /*5us*/
+    /*5us, independent of the slice length. Slices vary from 5 to 20 ms
+      (see pc_slice_next()) and are split further at rivatimer deadlines,
+      so deriving the period from cycs would change timer granularity*/
+    int32_t cyc_period = MAX(cpu_s->rspeed / 200000, 1);
 
 #    ifdef USE_ACYCS
     acycs = 0;
@@ -772,6 +849,9 @@ exec386_dynarec(int32_t cycs)
             tsc_old          = tsc;
             if ((!CACHE_ON()) || cpu_override_dynarec) /*Interpret block*/
             {
+#    ifdef USE_NEW_DYNAREC
+                codegen_block_last = BLOCK_INVALID;
+#    endif
                 exec386_dynarec_int();
             } else {
                 exec386_dynarec_dyn();
@@ -783,6 +863,9 @@ exec386_dynarec(int32_t cycs)
             }
 
             if (cpu_state.abrt) {
+#    ifdef USE_NEW_DYNAREC
+                codegen_block_last = BLOCK_INVALID;
+#    endif
                 flags_rebuild();
                 tempi          = cpu_state.abrt & ABRT_MASK;
                 cpu_state.abrt = 0;
@@ -808,17 +891,24 @@ exec386_dynarec(int32_t cycs)
             if (new_ne) {
 #    ifndef USE_NEW_DYNAREC
                 oldcs = CS;
+#    else
+                codegen_block_last = BLOCK_INVALID;
 #    endif
                 cpu_state.oldpc = cpu_state.pc;
                 new_ne = 0;
                 x86_int(16);
             }
 
-            if (smi_line)
+            if (smi_line) {
+#    ifdef USE_NEW_DYNAREC
+                codegen_block_last = BLOCK_INVALID;
+#    endif
                 enter_smm_check(0);
-            else if (nmi && nmi_enable && nmi_mask) {
+            } else if (nmi && nmi_enable && nmi_mask) {
 #    ifndef USE_NEW_DYNAREC
                 oldcs = CS;
+#    else
+                codegen_block_last = BLOCK_INVALID;
 #    endif
                 cpu_state.oldpc = cpu_state.pc;
                 x86_int(2);
@@ -836,6 +926,8 @@ exec386_dynarec(int32_t cycs)
                 if (vector != -1) {
 #    ifndef USE_NEW_DYNAREC
                     oldcs = CS;
+#    else
+                    codegen_block_last = BLOCK_INVALID;
 #    endif
                     cpu_state.oldpc = cpu_state.pc;
                     x86_int(vector);
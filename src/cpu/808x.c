@@ -74,6 +74,15 @@ static int       in_rep = 0, repeating = 0, rep_c_flag = 0;
 static int       oldc, clear_lock = 0;
 static int       refresh = 0, cycdiff;
 
+/* Fast mode: cycle debt is only settled at the end of a basic block (any
+   instruction that clears the prefetch queue), before I/O, or once it reaches
+   FAST_SETTLE_CYCLES, and the BIU is advanced a whole bus cycle at a time.
+   Build with ENABLE_808X_FAST_CHECK defined to check every BIU advance in
+   fast mode against the clock by clock stepping of the exact core. */
+#define FAST_SETTLE_CYCLES 128
+
+static int fast_block_end = 0;
+
 static i8080 emulated_processor;
 static bool cpu_md_write_disable = 1;
 
@@ -159,6 +168,7 @@ x808x_log(const char *fmt, ...)
 #endif
 
 static void pfq_add(int c, int add);
+static void pfq_add_fast(int c, int add);
 static void set_pzs(int bits);
 
 void
@@ -274,6 +284,24 @@ clock_end(void)
     tsc += (uint64_t) diff * ((uint64_t) xt_cpu_multi >> 32ULL); /* Shift xt_cpu_multi by 32 bits to the right and then multiply. */
     if (TIMER_VAL_LESS_THAN_VAL(timer_target, (uint32_t) tsc))
         timer_process();
+
+    /* In fast mode there is no clock_start() per instruction, so open the
+       next window here. */
+    if (cpu_808x_fast)
+        cycdiff = cycles;
+}
+
+/* Settles the cycle debt accumulated in fast mode. */
+static void
+clock_settle(void)
+{
+    /* Charge the memory refresh cycles stolen since the last settle in one go. */
+    if (refresh > 0) {
+        cycles -= refresh << 2;
+        refresh = 0;
+    }
+
+    clock_end();
 }
 
 static void
@@ -301,7 +329,20 @@ static void
 wait(int c, int bus)
 {
     cycles -= c;
-    fetch_and_bus(c, bus);
+    if (cpu_808x_fast)
+        pfq_add_fast(c, !bus);
+    else
+        fetch_and_bus(c, bus);
+}
+
+/* Waits for an I/O bus cycle. In fast mode the timers are brought up to date
+   first, so that the device sees the correct time. */
+static void
+io_wait(void)
+{
+    wait(is_mazovia ? 5 : 4, 1);
+    if (cpu_808x_fast)
+        clock_settle();
 }
 
 /* This is for external subtraction of cycles. */
@@ -313,8 +354,12 @@ sub_cycles(int c)
 
     cycles -= c;
 
-    if (!is286)
-        fetch_and_bus(c, 2);
+    if (!is286) {
+        if (cpu_808x_fast)
+            pfq_add_fast(c, 0);
+        else
+            fetch_and_bus(c, 2);
+    }
 }
 
 void
@@ -340,13 +385,13 @@ cpu_io(int bits, int out, uint16_t port)
     int old_cycles = cycles;
 
     if (out) {
-        wait(is_mazovia ? 5 : 4, 1);
+        io_wait();
         if (bits == 16) {
             if (is8086 && !(port & 1)) {
                 old_cycles = cycles;
                 outw(port, AX);
             } else {
-                wait(is_mazovia ? 5 : 4, 1);
+                io_wait();
                 old_cycles = cycles;
                 outb(port++, AL);
                 outb(port, AH);
@@ -356,13 +401,13 @@ cpu_io(int bits, int out, uint16_t port)
             outb(port, AL);
         }
     } else {
-        wait(is_mazovia ? 5 : 4, 1);
+        io_wait();
         if (bits == 16) {
             if (is8086 && !(port & 1)) {
                 old_cycles = cycles;
                 AX         = inw(port);
             } else {
-                wait(is_mazovia ? 5 : 4, 1);
+                io_wait();
                 old_cycles = cycles;
                 AL         = inb(port++);
                 AH         = inb(port);
@@ -617,12 +662,67 @@ pfq_add(int c, int add)
     }
 }
 
+#ifdef ENABLE_808X_FAST_CHECK
+/* Steps the BIU from the given state the way pfq_add() does, without
+   fetching, and compares the result with the one of pfq_add_fast(). */
+static void
+pfq_add_check(int c, int add, int old_biu_cycles, int old_pfq_pos)
+{
+    int biu = old_biu_cycles;
+    int pos = old_pfq_pos;
+
+    if ((c > 0) && (pos < pfq_size)) {
+        for (int d = 0; d < c; d++) {
+            biu = (biu + 1) & 0x03;
+            if (prefetching && add && (biu == 0x00)) {
+                if (is8086 && (pos < (pfq_size - 1)))
+                    pos += 2;
+                else if (!is8086 && (pos < pfq_size))
+                    pos++;
+            }
+        }
+    }
+
+    if ((biu != biu_cycles) || (pos != pfq_pos))
+        fatal("808x fast: %i cycles from BIU %i, queue %i: got BIU %i, queue %i, exact core %i, %i\n",
+              c, old_biu_cycles, old_pfq_pos, biu_cycles, pfq_pos, biu, pos);
+}
+#endif
+
+/* Fast mode version of pfq_add(), fetches as many bytes as there were whole
+   bus cycles instead of stepping the BIU one clock at a time. */
+static void
+pfq_add_fast(int c, int add)
+{
+    int fetches;
+#ifdef ENABLE_808X_FAST_CHECK
+    int old_biu_cycles = biu_cycles;
+    int old_pfq_pos    = pfq_pos;
+#endif
+
+    /* As in pfq_add(), the BIU does not advance while the queue is full. */
+    if ((c > 0) && (pfq_pos < pfq_size)) {
+        fetches    = (biu_cycles + c) >> 2;
+        biu_cycles = (biu_cycles + c) & 0x03;
+
+        if (prefetching && add) {
+            while ((fetches-- > 0) && (pfq_pos < pfq_size))
+                pfq_write();
+        }
+    }
+
+#ifdef ENABLE_808X_FAST_CHECK
+    pfq_add_check(c, add, old_biu_cycles, old_pfq_pos);
+#endif
+}
+
 /* Clear the prefetch queue - called on reset and on anything that affects either CS or IP. */
 static void
 pfq_clear(void)
 {
-    pfq_pos     = 0;
-    prefetching = 0;
+    pfq_pos        = 0;
+    prefetching    = 0;
+    fast_block_end = 1;
 }
 
 static void
@@ -1848,7 +1948,7 @@ cpu_inb(uint16_t port)
     int     old_cycles = cycles;
     uint8_t ret;
 
-    wait(is_mazovia ? 5 : 4, 1);
+    io_wait();
     old_cycles = cycles;
 
     ret = inb(port);
@@ -1864,12 +1964,12 @@ cpu_inw(uint16_t port)
     int      old_cycles = cycles;
     uint16_t ret;
 
-    wait(is_mazovia ? 5 : 4, 1);
+    io_wait();
     if (is8086 && !(port & 1)) {
         old_cycles = cycles;
         ret = inw(port);
     } else {
-        wait(is_mazovia ? 5 : 4, 1);
+        io_wait();
         old_cycles = cycles;
         ret = inb(port++);
         ret |= (inb(port) << 8);
@@ -1885,7 +1985,7 @@ cpu_outb(uint16_t port, uint16_t val)
 {
     int old_cycles = cycles;
 
-    wait(is_mazovia ? 5 : 4, 1);
+    io_wait();
     old_cycles = cycles;
 
     outb(port, val);
@@ -1898,13 +1998,13 @@ cpu_outw(uint16_t port, uint16_t val)
 {
     int old_cycles = cycles;
 
-    wait(is_mazovia ? 5 : 4, 1);
+    io_wait();
 
     if (is8086 && !(port & 1)) {
         old_cycles = cycles;
         outw(port, val);
     } else {
-        wait(is_mazovia ? 5 : 4, 1);
+        io_wait();
         old_cycles = cycles;
         outb(port++, val);
         outb(port, val >> 8);
@@ -1933,9 +2033,13 @@ execx86(int cycs)
 
     cycles += cycs;
 
-    while (cycles > 0) {
+    if (cpu_808x_fast)
         clock_start();
 
+    while (cycles > 0) {
+        if (!cpu_808x_fast)
+            clock_start();
+
         if (is_nec && !(cpu_state.flags & MD_FLAG)) {
             i8080_step(&emulated_processor);
             set_if(emulated_processor.iff);
@@ -3847,7 +3951,12 @@ exec_completed:
             rep_c_flag = 0;
             if (in_lock)
                 clear_lock = 1;
-            clock_end();
+            if (!cpu_808x_fast)
+                clock_end();
+            else if (fast_block_end || ((cycdiff - cycles) >= FAST_SETTLE_CYCLES)) {
+                fast_block_end = 0;
+                clock_settle();
+            }
             check_interrupts();
 
             if (noint)
@@ -3858,7 +3967,10 @@ exec_completed:
 
 #ifdef USE_GDBSTUB
         if (gdbstub_instruction())
-            return;
+            break;
 #endif
     }
+
+    if (cpu_808x_fast)
+        clock_settle();
 }
@@ -51,6 +51,10 @@
 
 extern void codegen_init(void);
 extern void codegen_flush(void);
+#ifdef USE_NEW_DYNAREC
+extern void codegen_hint_cache_load(void);
+extern void codegen_hint_cache_save(void);
+#endif
 
 /*Current physical page of block being recompiled. -1 if no recompilation taking place */
 extern uint32_t recomp_page;
@@ -883,3 +883,217 @@ uint64_t opcode_deps_8x_mod3[8] = {
         SRCDEP_RM | DSTDEP_RM | MODRM | HAS_IMM8,  SRCDEP_RM | DSTDEP_RM | MODRM | HAS_IMM8,  SRCDEP_RM | DSTDEP_RM | MODRM | HAS_IMM8,  SRCDEP_RM | MODRM | HAS_IMM8
     // clang-format on
 };
+
+uint16_t addr_regmask_a16[256];
+uint16_t addr_regmask_a32[256];
+uint16_t addr_regmask_sib[256];
+
+#ifndef RELEASE_BUILD
+/*Per-instruction decoding that the tables above replace, kept to check them
+  against*/
+static uint32_t
+addr_regmask_ref(uint8_t modrm, uint8_t sib, int op_32)
+{
+    uint32_t addr_regmask = 0;
+
+    if ((modrm & 0xc0) != 0xc0) {
+        if (op_32 & 0x200) {
+            if ((modrm & 0x7) == 4) {
+                if ((sib & 7) != 5) {
+                    addr_regmask = 1 << (sib & 7);
+                    if ((sib & 0x38) != 0x20)
+                        addr_regmask |= 1 << ((sib >> 3) & 7);
+                }
+            } else if ((modrm & 0xc7) != 5) {
+                addr_regmask = 1 << (modrm & 7);
+            }
+        } else {
+            if ((modrm & 0xc7) != 0x06) {
+                switch (modrm & 7) {
+                    case 0:
+                        addr_regmask = REG_BX | REG_SI;
+                        break;
+                    case 1:
+                        addr_regmask = REG_BX | REG_DI;
+                        break;
+                    case 2:
+                        addr_regmask = REG_BP | REG_SI;
+                        break;
+                    case 3:
+                        addr_regmask = REG_BP | REG_DI;
+                        break;
+                    case 4:
+                        addr_regmask = REG_SI;
+                        break;
+                    case 5:
+                        addr_regmask = REG_DI;
+                        break;
+                    case 6:
+                        addr_regmask = REG_BP;
+                        break;
+                    case 7:
+                        addr_regmask = REG_BX;
+                        break;
+                }
+            }
+        }
+    }
+
+    return addr_regmask;
+}
+#endif /* RELEASE_BUILD */
+
+void
+codegen_timing_common_init(void)
+{
+    static const uint16_t regmask_a16[8] = {
+        REG_BX | REG_SI, REG_BX | REG_DI, REG_BP | REG_SI, REG_BP | REG_DI,
+        REG_SI, REG_DI, REG_BP, REG_BX
+    };
+
+    for (int c = 0; c < 256; c++) {
+        int mod  = c >> 6;
+        int rm   = c & 7;
+        int base = c & 7;
+        int idx  = (c >> 3) & 7;
+
+        if (mod == 3 || (c & 0xc7) == 0x06)
+            addr_regmask_a16[c] = 0;
+        else
+            addr_regmask_a16[c] = regmask_a16[rm];
+
+        if (mod == 3 || (c & 0xc7) == 0x05)
+            addr_regmask_a32[c] = 0;
+        else if (rm == 4)
+            addr_regmask_a32[c] = ADDR_REGMASK_SIB;
+        else
+            addr_regmask_a32[c] = 1 << rm;
+
+        /*A base of 5 (disp32 or EBP) is not tracked, index included*/
+        if (base == 5)
+            addr_regmask_sib[c] = 0;
+        else
+            addr_regmask_sib[c] = (1 << base) | ((idx != 4) ? (1 << idx) : 0);
+    }
+
+#ifndef RELEASE_BUILD
+    for (int op_32 = 0; op_32 <= 0x200; op_32 += 0x200) {
+        for (uint32_t fetchdat = 0; fetchdat < 0x10000; fetchdat++) {
+            uint32_t mask = get_addr_regmask(MODRM, fetchdat, op_32);
+            uint32_t ref  = addr_regmask_ref(fetchdat & 0xff, fetchdat >> 8, op_32);
+
+            if (mask != ref)
+                fatal("codegen_timing_common_init: addr_regmask mismatch %04x %03x : %03x %03x\n", fetchdat, op_32, mask, ref);
+        }
+    }
+#endif /* RELEASE_BUILD */
+}
+
+const uint64_t *const codegen_timing_table_deps[TIMINGS_NR] = {
+    // clang-format off
+    opcode_deps,       opcode_deps_mod3,
+    opcode_deps_0f,    opcode_deps_0f_mod3,
+    opcode_deps_shift, opcode_deps_shift_mod3,
+    opcode_deps_f6,    opcode_deps_f6_mod3,
+    opcode_deps_f7,    opcode_deps_f7_mod3,
+    opcode_deps_ff,    opcode_deps_ff_mod3,
+    opcode_deps_d8,    opcode_deps_d8_mod3,
+    opcode_deps_d9,    opcode_deps_d9_mod3,
+    opcode_deps_da,    opcode_deps_da_mod3,
+    opcode_deps_db,    opcode_deps_db_mod3,
+    opcode_deps_dc,    opcode_deps_dc_mod3,
+    opcode_deps_dd,    opcode_deps_dd_mod3,
+    opcode_deps_de,    opcode_deps_de_mod3,
+    opcode_deps_df,    opcode_deps_df_mod3,
+    opcode_deps_8x,    opcode_deps_8x_mod3,
+    opcode_deps_81,    opcode_deps_81_mod3
+    // clang-format on
+};
+
+static const int codegen_timing_table_size[TIMINGS_NR] = {
+    // clang-format off
+    256, 256, /*BASE*/
+    256, 256, /*0F*/
+      8,   8, /*SHIFT*/
+      8,   8, /*F6*/
+      8,   8, /*F7*/
+      8,   8, /*FF*/
+      8,   8, /*D8*/
+      8,  64, /*D9*/
+      8,   8, /*DA*/
+      8,  64, /*DB*/
+      8,   8, /*DC*/
+      8,   8, /*DD*/
+      8,   8, /*DE*/
+      8,   8, /*DF*/
+      8,   8, /*8X*/
+      8,   8  /*81*/
+    // clang-format on
+};
+
+static inline int
+COUNT(int *c, int op_32)
+{
+    if ((uintptr_t) c <= 10000)
+        return (int) (uintptr_t) c;
+    if (((uintptr_t) c & ~0xffff) == (-1 & ~0xffff)) {
+        if (op_32 & 0x100)
+            return ((uintptr_t) c >> 8) & 0xff;
+        return (uintptr_t) c & 0xff;
+    }
+    return *c;
+}
+
+void
+codegen_timing_tables_init(codegen_timing_tables_t *tables)
+{
+    int offset = 0;
+
+    for (int table = 0; table < TIMINGS_NR; table++) {
+        tables->offsets[table] = offset;
+        for (int c = 0; c < codegen_timing_table_size[table]; c++) {
+            tables->counts[0][offset + c] = COUNT(tables->timings[table][c], 0);
+            tables->counts[1][offset + c] = COUNT(tables->timings[table][c], 0x100);
+        }
+        offset += codegen_timing_table_size[table];
+    }
+
+#ifndef RELEASE_BUILD
+    if (offset != TIMINGS_TOTAL)
+        fatal("codegen_timing_tables_init: %i timings, expected %i\n", offset, TIMINGS_TOTAL);
+
+    /*Check the lookup against the model's original one, for every prefix byte,
+      and for every prefix, opcode and ModR/M byte in both operand and address
+      sizes. Only the counts change on later calls, so those only go through
+      the prefixes that select tables of their own*/
+    for (int c = 0; c < 256; c++) {
+        uint64_t ref_dep;
+
+        if (codegen_timing_table_count(tables, TIMINGS_BASE, c, 0) != COUNT(tables->ref(-1, c, 0, &ref_dep), 0))
+            fatal("codegen_timing_tables_init: prefix %02x timing mismatch\n", c);
+    }
+
+    for (int prefix = 0; prefix < 256; prefix++) {
+        if (tables->checked && prefix && (prefix != 0x0f) && ((prefix & 0xf8) != 0xd8))
+            continue;
+
+        for (int c = 0; c < 256 * 256; c++) {
+            uint8_t  opcode   = c & 0xff;
+            uint32_t fetchdat = c >> 8;
+            uint64_t ref_dep;
+            int     *ref      = tables->ref(prefix, opcode, fetchdat, &ref_dep);
+            int      table    = codegen_timing_table_select(prefix, &opcode, fetchdat);
+
+            if (opcode >= codegen_timing_table_size[table])
+                fatal("codegen_timing_tables_init: %02x %02x %02x out of range of table %i\n", prefix, c & 0xff, fetchdat, table);
+            if (codegen_timing_table_deps[table][opcode] != ref_dep)
+                fatal("codegen_timing_tables_init: %02x %02x %02x dependency mismatch\n", prefix, c & 0xff, fetchdat);
+            for (int op_32 = 0; op_32 < 0x400; op_32 += 0x100) {
+                if (codegen_timing_table_count(tables, table, opcode, op_32) != COUNT(ref, op_32))
+                    fatal("codegen_timing_tables_init: %02x %02x %02x %03x timing mismatch\n", prefix, c & 0xff, fetchdat, op_32);
+            }
+        }
+    }
+    tables->checked = 1;
+#endif /* RELEASE_BUILD */
+}
@@ -116,6 +116,15 @@ extern uint64_t opcode_deps_81_mod3[8];
 extern uint64_t opcode_deps_8x[8];
 extern uint64_t opcode_deps_8x_mod3[8];
 
+/*Address registers used by each ModR/M form, built by
+  codegen_timing_common_init(). 32-bit forms with a SIB byte are marked with
+  ADDR_REGMASK_SIB and looked up in addr_regmask_sib[] instead*/
+#define ADDR_REGMASK_SIB 0x8000
+
+extern uint16_t addr_regmask_a16[256];
+extern uint16_t addr_regmask_a32[256];
+extern uint16_t addr_regmask_sib[256];
+
 static inline uint32_t
 get_addr_regmask(uint64_t data, uint32_t fetchdat, int op_32)
 {
@@ -124,50 +133,12 @@ get_addr_regmask(uint64_t data, uint32_t fetchdat, int op_32)
     if (data & MODRM) {
         uint8_t modrm = fetchdat & 0xff;
 
-        if ((modrm & 0xc0) != 0xc0) {
-            if (op_32 & 0x200) {
-                if ((modrm & 0x7) == 4) {
-                    uint8_t sib = (fetchdat >> 8) & 0xff;
-
-                    if ((modrm & 0xc0) != 0xc0 && (sib & 7) != 5) {
-                        addr_regmask = 1 << (sib & 7);
-                        if ((sib & 0x38) != 0x20)
-                            addr_regmask |= 1 << ((sib >> 3) & 7);
-                    }
-                } else if ((modrm & 0xc7) != 5) {
-                    addr_regmask = 1 << (modrm & 7);
-                }
-            } else {
-                if ((modrm & 0xc7) != 0x06) {
-                    switch (modrm & 7) {
-                        case 0:
-                            addr_regmask = REG_BX | REG_SI;
-                            break;
-                        case 1:
-                            addr_regmask = REG_BX | REG_DI;
-                            break;
-                        case 2:
-                            addr_regmask = REG_BP | REG_SI;
-                            break;
-                        case 3:
-                            addr_regmask = REG_BP | REG_DI;
-                            break;
-                        case 4:
-                            addr_regmask = REG_SI;
-                            break;
-                        case 5:
-                            addr_regmask = REG_DI;
-                            break;
-                        case 6:
-                            addr_regmask = REG_BP;
-                            break;
-                        case 7:
-                            addr_regmask = REG_BX;
-                            break;
-                    }
-                }
-            }
-        }
+        if (op_32 & 0x200) {
+            addr_regmask = addr_regmask_a32[modrm];
+            if (addr_regmask & ADDR_REGMASK_SIB)
+                addr_regmask = addr_regmask_sib[(fetchdat >> 8) & 0xff];
+        } else
+            addr_regmask = addr_regmask_a16[modrm];
     }
 
     if (data & IMPL_ESP)
@@ -229,3 +200,147 @@ get_dstdep_mask(uint64_t data, uint32_t fetchdat, int bit8)
 
     return mask;
 }
+
+/*Tables of the 486 style timing models (486 and WinChip), as picked by
+  codegen_timing_table_select(). The _MOD3 variant of each table directly
+  follows the variant with a memory operand*/
+enum {
+    TIMINGS_BASE = 0,
+    TIMINGS_BASE_MOD3,
+    TIMINGS_0F,
+    TIMINGS_0F_MOD3,
+    TIMINGS_SHIFT,
+    TIMINGS_SHIFT_MOD3,
+    TIMINGS_F6,
+    TIMINGS_F6_MOD3,
+    TIMINGS_F7,
+    TIMINGS_F7_MOD3,
+    TIMINGS_FF,
+    TIMINGS_FF_MOD3,
+    TIMINGS_D8,
+    TIMINGS_D8_MOD3,
+    TIMINGS_D9,
+    TIMINGS_D9_MOD3,
+    TIMINGS_DA,
+    TIMINGS_DA_MOD3,
+    TIMINGS_DB,
+    TIMINGS_DB_MOD3,
+    TIMINGS_DC,
+    TIMINGS_DC_MOD3,
+    TIMINGS_DD,
+    TIMINGS_DD_MOD3,
+    TIMINGS_DE,
+    TIMINGS_DE_MOD3,
+    TIMINGS_DF,
+    TIMINGS_DF_MOD3,
+    TIMINGS_8X,
+    TIMINGS_8X_MOD3,
+    TIMINGS_81,
+    TIMINGS_81_MOD3,
+    TIMINGS_NR
+};
+
+/*Sum of the sizes of all the tables*/
+#define TIMINGS_TOTAL 1360
+
+typedef struct codegen_timing_tables_t {
+    /*Source tables of the model, indexed by TIMINGS_*. Entries are either
+      NULL, a fixed count, a 16/32-bit pair or a timing_* variable*/
+    int **timings[TIMINGS_NR];
+    /*Counts of all the tables with the entries resolved, indexed by operand
+      size, then by the table's offset plus opcode. Rebuilt by
+      codegen_timing_tables_init() on every cpu_set(), after the timing_*
+      variables for the new CPU have been set*/
+    uint16_t counts[2][TIMINGS_TOTAL];
+    int      offsets[TIMINGS_NR];
+#ifndef RELEASE_BUILD
+    /*The model's original per-opcode lookup, which codegen_timing_tables_init()
+      checks the above against. Returns the source table entry and the
+      dependencies for an instruction, or the entry for a prefix byte if
+      prefix is -1*/
+    int *(*ref)(int prefix, uint8_t opcode, uint32_t fetchdat, uint64_t *dep);
+    int checked;
+#endif
+} codegen_timing_tables_t;
+
+extern const uint64_t *const codegen_timing_table_deps[TIMINGS_NR];
+
+extern void codegen_timing_tables_init(codegen_timing_tables_t *tables);
+
+/*Returns the table to use for an instruction, and replaces opcode with the
+  index into that table*/
+static inline int
+codegen_timing_table_select(uint8_t prefix, uint8_t *opcode, uint32_t fetchdat)
+{
+    int mod3 = ((fetchdat & 0xc0) == 0xc0);
+
+    switch (prefix) {
+        case 0x0f:
+            return TIMINGS_0F + mod3;
+
+        case 0xd8:
+            *opcode = (*opcode >> 3) & 7;
+            return TIMINGS_D8 + mod3;
+        case 0xd9:
+            *opcode = mod3 ? *opcode & 0x3f : (*opcode >> 3) & 7;
+            return TIMINGS_D9 + mod3;
+        case 0xda:
+            *opcode = (*opcode >> 3) & 7;
+            return TIMINGS_DA + mod3;
+        case 0xdb:
+            *opcode = mod3 ? *opcode & 0x3f : (*opcode >> 3) & 7;
+            return TIMINGS_DB + mod3;
+        case 0xdc:
+            *opcode = (*opcode >> 3) & 7;
+            return TIMINGS_DC + mod3;
+        case 0xdd:
+            *opcode = (*opcode >> 3) & 7;
+            return TIMINGS_DD + mod3;
+        case 0xde:
+            *opcode = (*opcode >> 3) & 7;
+            return TIMINGS_DE + mod3;
+        case 0xdf:
+            *opcode = (*opcode >> 3) & 7;
+            return TIMINGS_DF + mod3;
+
+        default:
+            switch (*opcode) {
+                case 0x80:
+                case 0x82:
+                case 0x83:
+                    *opcode = (fetchdat >> 3) & 7;
+                    return TIMINGS_8X + mod3;
+                case 0x81:
+                    *opcode = (fetchdat >> 3) & 7;
+                    return TIMINGS_81 + mod3;
+
+                case 0xc0:
+                case 0xc1:
+                case 0xd0:
+                case 0xd1:
+                case 0xd2:
+                case 0xd3:
+                    *opcode = (fetchdat >> 3) & 7;
+                    return TIMINGS_SHIFT + mod3;
+
+                case 0xf6:
+                    *opcode = (fetchdat >> 3) & 7;
+                    return TIMINGS_F6 + mod3;
+                case 0xf7:
+                    *opcode = (fetchdat >> 3) & 7;
+                    return TIMINGS_F7 + mod3;
+                case 0xff:
+                    *opcode = (fetchdat >> 3) & 7;
+                    return TIMINGS_FF + mod3;
+
+                default:
+                    return TIMINGS_BASE + mod3;
+            }
+    }
+}
+
+static inline int
+codegen_timing_table_count(const codegen_timing_tables_t *tables, int table, uint8_t opcode, int op_32)
+{
+    return tables->counts[(op_32 >> 8) & 1][tables->offsets[table] + opcode];
+}
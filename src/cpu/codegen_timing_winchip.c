@@ -297,52 +297,23 @@ static int *opcode_timings_winchip_81_mod3[8] =
     // clang-format on
 };
 
-static int      timing_count;
-static uint8_t  last_prefix;
-static uint32_t regmask_modified;
-
-static inline int
-COUNT(int *c, int op_32)
-{
-    if ((uintptr_t) c <= 10000)
-        return (int) (uintptr_t) c;
-    if (((uintptr_t) c & ~0xffff) == (-1 & ~0xffff)) {
-        if (op_32 & 0x100)
-            return ((uintptr_t) c >> 8) & 0xff;
-        return (uintptr_t) c & 0xff;
-    }
-    return *c;
-}
-
-void
-codegen_timing_winchip_block_start(void)
-{
-    regmask_modified = 0;
-}
-
-void
-codegen_timing_winchip_start(void)
-{
-    timing_count = 0;
-    last_prefix  = 0;
-}
-
-void
-codegen_timing_winchip_prefix(uint8_t prefix, UNUSED(uint32_t fetchdat))
-{
-    timing_count += COUNT(opcode_timings_winchip[prefix], 0);
-    last_prefix = prefix;
-}
-
-void
-codegen_timing_winchip_opcode(uint8_t opcode, uint32_t fetchdat, int op_32, UNUSED(uint32_t op_pc))
+#ifndef RELEASE_BUILD
+/*The per-opcode lookup that timing_tables replaces, kept to check it against.
+  Returns the source table entry for an instruction, or for a prefix byte if
+  prefix is -1*/
+static int *
+codegen_timing_winchip_ref(int prefix, uint8_t opcode, uint32_t fetchdat, uint64_t *dep)
 {
     int           **timings;
     const uint64_t *deps;
     int             mod3 = ((fetchdat & 0xc0) == 0xc0);
-    int             bit8 = !(opcode & 1);
 
-    switch (last_prefix) {
+    if (prefix == -1) {
+        *dep = 0;
+        return opcode_timings_winchip[opcode];
+    }
+
+    switch (prefix) {
         case 0x0f:
             timings = mod3 ? opcode_timings_winchip_0f_mod3 : opcode_timings_winchip_0f;
             deps    = mod3 ? opcode_deps_0f_mod3 : opcode_deps_0f;
@@ -438,7 +409,91 @@ codegen_timing_winchip_opcode(uint8_t opcode, uint32_t fetchdat, int op_32, UNUS
             }
     }
 
-    timing_count += COUNT(timings[opcode], op_32);
+    *dep = deps[opcode];
+    return timings[opcode];
+}
+#endif /* RELEASE_BUILD */
+
+static codegen_timing_tables_t timing_tables = {
+    .timings = {
+        // clang-format off
+        [TIMINGS_BASE]       = opcode_timings_winchip,
+        [TIMINGS_BASE_MOD3]  = opcode_timings_winchip_mod3,
+        [TIMINGS_0F]         = opcode_timings_winchip_0f,
+        [TIMINGS_0F_MOD3]    = opcode_timings_winchip_0f_mod3,
+        [TIMINGS_SHIFT]      = opcode_timings_winchip_shift,
+        [TIMINGS_SHIFT_MOD3] = opcode_timings_winchip_shift_mod3,
+        [TIMINGS_F6]         = opcode_timings_winchip_f6,
+        [TIMINGS_F6_MOD3]    = opcode_timings_winchip_f6_mod3,
+        [TIMINGS_F7]         = opcode_timings_winchip_f7,
+        [TIMINGS_F7_MOD3]    = opcode_timings_winchip_f7_mod3,
+        [TIMINGS_FF]         = opcode_timings_winchip_ff,
+        [TIMINGS_FF_MOD3]    = opcode_timings_winchip_ff_mod3,
+        [TIMINGS_D8]         = opcode_timings_winchip_d8,
+        [TIMINGS_D8_MOD3]    = opcode_timings_winchip_d8_mod3,
+        [TIMINGS_D9]         = opcode_timings_winchip_d9,
+        [TIMINGS_D9_MOD3]    = opcode_timings_winchip_d9_mod3,
+        [TIMINGS_DA]         = opcode_timings_winchip_da,
+        [TIMINGS_DA_MOD3]    = opcode_timings_winchip_da_mod3,
+        [TIMINGS_DB]         = opcode_timings_winchip_db,
+        [TIMINGS_DB_MOD3]    = opcode_timings_winchip_db_mod3,
+        [TIMINGS_DC]         = opcode_timings_winchip_dc,
+        [TIMINGS_DC_MOD3]    = opcode_timings_winchip_dc_mod3,
+        [TIMINGS_DD]         = opcode_timings_winchip_dd,
+        [TIMINGS_DD_MOD3]    = opcode_timings_winchip_dd_mod3,
+        [TIMINGS_DE]         = opcode_timings_winchip_de,
+        [TIMINGS_DE_MOD3]    = opcode_timings_winchip_de_mod3,
+        [TIMINGS_DF]         = opcode_timings_winchip_df,
+        [TIMINGS_DF_MOD3]    = opcode_timings_winchip_df_mod3,
+        [TIMINGS_8X]         = opcode_timings_winchip_8x,
+        [TIMINGS_8X_MOD3]    = opcode_timings_winchip_8x_mod3,
+        [TIMINGS_81]         = opcode_timings_winchip_81,
+        [TIMINGS_81_MOD3]    = opcode_timings_winchip_81_mod3,
+        // clang-format on
+    },
+#ifndef RELEASE_BUILD
+    .ref = codegen_timing_winchip_ref
+#endif
+};
+
+static int      timing_count;
+static uint8_t  last_prefix;
+static uint32_t regmask_modified;
+
+void
+codegen_timing_winchip_init(void)
+{
+    codegen_timing_tables_init(&timing_tables);
+}
+
+void
+codegen_timing_winchip_block_start(void)
+{
+    regmask_modified = 0;
+}
+
+void
+codegen_timing_winchip_start(void)
+{
+    timing_count = 0;
+    last_prefix  = 0;
+}
+
+void
+codegen_timing_winchip_prefix(uint8_t prefix, UNUSED(uint32_t fetchdat))
+{
+    timing_count += codegen_timing_table_count(&timing_tables, TIMINGS_BASE, prefix, 0);
+    last_prefix = prefix;
+}
+
+void
+codegen_timing_winchip_opcode(uint8_t opcode, uint32_t fetchdat, int op_32, UNUSED(uint32_t op_pc))
+{
+    int             bit8  = !(opcode & 1);
+    int             table = codegen_timing_table_select(last_prefix, &opcode, fetchdat);
+    const uint64_t *deps  = codegen_timing_table_deps[table];
+
+    timing_count += codegen_timing_table_count(&timing_tables, table, opcode, op_32);
     if (regmask_modified & get_addr_regmask(deps[opcode], fetchdat, op_32))
         timing_count++; /*AGI stall*/
     codegen_block_cycles += timing_count;
@@ -458,5 +513,6 @@ codegen_timing_t codegen_timing_winchip = {
     codegen_timing_winchip_opcode,
     codegen_timing_winchip_block_start,
     codegen_timing_winchip_block_end,
-    NULL
+    NULL,
+    codegen_timing_winchip_init
 };
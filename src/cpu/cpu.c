@@ -58,9 +58,6 @@
 #define CCR3_SMI_LOCK (1 << 0)
 #define CCR3_NMI_EN   (1 << 1)
 
-SSE_REG  XMM[8];
-uint32_t mxcsr;
-
 enum {
     CPUID_FPU       = (1 << 0),  /* On-chip Floating Point Unit */
     CPUID_VME       = (1 << 1),  /* Virtual 8086 mode extensions */
@@ -2193,10 +2190,22 @@ cpu_set(void)
                 cpu_use_exec = 1;
             } else
                 cpu_exec = exec386_2386;
-    } else if (cpu_s->cpu_type >= CPU_286)
-        cpu_exec = exec386_2386;
-    else
+    } else if (cpu_s->cpu_type >= CPU_286) {
+#if defined(USE_DYNAREC) && defined(USE_NEW_DYNAREC) && !defined(USE_GDBSTUB)
+        /* The 286 runs its own opcode tables on the 386 dynarec, with
+           anything the 286 lacks left to the interpreter. Only the new
+           code generator knows to do that. */
+        if (cpu_use_dynarec && (cpu_s->cpu_flags & CPU_SUPPORTS_DYNAREC)) {
+            cpu_exec = exec386_dynarec;
+            cpu_use_exec = 1;
+        } else
+#endif /* defined(USE_DYNAREC) && defined(USE_NEW_DYNAREC) && !defined(USE_GDBSTUB) */
+            cpu_exec = exec386_2386;
+    } else
         cpu_exec = execx86;
+#ifdef USE_DYNAREC
+    codegen_timing_init();
+#endif /* USE_DYNAREC */
     mmx_init();
     gdbstub_cpu_init();
 }
@@ -2204,6 +2213,9 @@ cpu_set(void)
 void
 cpu_close(void)
 {
+    if (fpu_softfloat && fpu_softfloat_fast)
+        x87_sf_fast_log_stats();
+
     cpu_inited = 0;
 }
 
@@ -466,6 +466,9 @@ typedef struct {
     uint32_t _smbase;
 
     uint32_t x87_op;
+
+    SSE_REG  _XMM[8];
+    uint32_t _mxcsr;
 } cpu_state_t;
 
 #define in_smm   cpu_state._in_smm
@@ -474,6 +477,8 @@ typedef struct {
 extern int sse_xmm;
 
 #define smbase cpu_state._smbase
+#define XMM    cpu_state._XMM
+#define mxcsr  cpu_state._mxcsr
 
 /*The cpu_state.flags below must match in both cpu_cur_status and block->status for a block
   to be valid*/
@@ -491,15 +496,20 @@ extern int sse_xmm;
 /*If the cpu_state.flags below are set in cpu_cur_status, they must be set in block->status.
   Otherwise they are ignored*/
 #ifdef USE_NEW_DYNAREC
-#    define CPU_STATUS_NOTFLATDS (1 << 8)
-#    define CPU_STATUS_NOTFLATSS (1 << 9)
-#    define CPU_STATUS_MASK      0xff00
+#    define CPU_STATUS_NOTFLATDS   (1 << 8)
+#    define CPU_STATUS_NOTFLATSS   (1 << 9)
+#    define CPU_STATUS_NOTDEFMXCSR (1 << 10)
+#    define CPU_STATUS_MASK        0xff00
 #else
 #    define CPU_STATUS_NOTFLATDS (1 << 16)
 #    define CPU_STATUS_NOTFLATSS (1 << 17)
 #    define CPU_STATUS_MASK      0xffff0000
 #endif
 
+/*MXCSR control bits (DAZ, exception masks, rounding control and FZ) after reset*/
+#define MXCSR_CONTROL_MASK    0xffc0
+#define MXCSR_CONTROL_DEFAULT 0x1f80
+
 #ifdef _MSC_VER
 #    define COMPILE_TIME_ASSERT(expr) /*nada*/
 #else
@@ -643,8 +653,6 @@ extern uint16_t temp_seg_data[4];
 extern uint16_t cs_msr;
 extern uint32_t esp_msr;
 extern uint32_t eip_msr;
-extern SSE_REG  XMM[8];
-extern uint32_t mxcsr;
 
 /* For the AMD K6. */
 extern uint64_t amd_efer;
@@ -771,6 +779,7 @@ extern void cpu_set_isa_speed(int speed);
 extern void cpu_set_pci_speed(int speed);
 extern void cpu_set_isa_pci_div(int div);
 extern void cpu_set_agp_speed(int speed);
+extern void cpu_set_mxcsr(uint32_t val);
 
 extern void cpu_CPUID(void);
 extern void cpu_RDMSR(void);
@@ -784,6 +793,7 @@ extern int  divl(uint32_t val);
 extern void execx86(int32_t cycs);
 extern void enter_smm(int in_hlt);
 extern void enter_smm_check(int in_hlt);
+extern int32_t cpu_hlt_idle_cycles(void);
 extern void leave_smm(void);
 extern void exec386_2386(int32_t cycs);
 extern void exec386(int32_t cycs);
@@ -805,6 +815,8 @@ extern void x87_dumpregs(void);
 extern void x87_reset(void);
 #endif
 
+extern void x87_sf_fast_log_stats(void);
+
 extern int  cpu_effective;
 extern int  cpu_alt_reset;
 extern void cpu_dynamic_switch(int new_cpu);
@@ -34,6 +34,13 @@
 #include "cpu.h"
 #include <86box/machine.h>
 
+/* Only the new dynarec knows how to translate for a 286. */
+#ifdef USE_NEW_DYNAREC
+#    define CPU_286_DYNAREC CPU_SUPPORTS_DYNAREC
+#else
+#    define CPU_286_DYNAREC 0
+#endif
+
 FPU fpus_none[] = {
     { .name = "None", .internal_name = "none", .type = FPU_NONE },
     { .name = NULL,   .internal_name = NULL,   .type = 0        }
@@ -1014,7 +1021,7 @@ const cpu_family_t cpu_families[] = {
                 .edx_reset          = 0,
                 .cpuid_model        = 0,
                 .cyrix_id           = 0,
-                .cpu_flags          = 0,
+                .cpu_flags          = CPU_286_DYNAREC,
                 .mem_read_cycles    = 2,
                 .mem_write_cycles   = 2,
                 .cache_read_cycles  = 2,
@@ -1031,7 +1038,7 @@ const cpu_family_t cpu_families[] = {
                 .edx_reset          = 0,
                 .cpuid_model        = 0,
                 .cyrix_id           = 0,
-                .cpu_flags          = 0,
+                .cpu_flags          = CPU_286_DYNAREC,
                 .mem_read_cycles    = 2,
                 .mem_write_cycles   = 2,
                 .cache_read_cycles  = 2,
@@ -1048,7 +1055,7 @@ const cpu_family_t cpu_families[] = {
                 .edx_reset          = 0,
                 .cpuid_model        = 0,
                 .cyrix_id           = 0,
-                .cpu_flags          = 0,
+                .cpu_flags          = CPU_286_DYNAREC,
                 .mem_read_cycles    = 2,
                 .mem_write_cycles   = 2,
                 .cache_read_cycles  = 2,
@@ -1065,7 +1072,7 @@ const cpu_family_t cpu_families[] = {
                 .edx_reset          = 0,
                 .cpuid_model        = 0,
                 .cyrix_id           = 0,
-                .cpu_flags          = 0,
+                .cpu_flags          = CPU_286_DYNAREC,
                 .mem_read_cycles    = 3,
                 .mem_write_cycles   = 3,
                 .cache_read_cycles  = 3,
@@ -1082,7 +1089,7 @@ const cpu_family_t cpu_families[] = {
                 .edx_reset          = 0,
                 .cpuid_model        = 0,
                 .cyrix_id           = 0,
-                .cpu_flags          = 0,
+                .cpu_flags          = CPU_286_DYNAREC,
                 .mem_read_cycles    = 3,
                 .mem_write_cycles   = 3,
                 .cache_read_cycles  = 3,
@@ -1099,7 +1106,7 @@ const cpu_family_t cpu_families[] = {
                 .edx_reset          = 0,
                 .cpuid_model        = 0,
                 .cyrix_id           = 0,
-                .cpu_flags          = 0,
+                .cpu_flags          = CPU_286_DYNAREC,
                 .mem_read_cycles    = 4,
                 .mem_write_cycles   = 4,
                 .cache_read_cycles  = 4,
@@ -1116,7 +1123,7 @@ const cpu_family_t cpu_families[] = {
                 .edx_reset          = 0,
                 .cpuid_model        = 0,
                 .cyrix_id           = 0,
-                .cpu_flags          = 0,
+                .cpu_flags          = CPU_286_DYNAREC,
                 .mem_read_cycles    = 4,
                 .mem_write_cycles   = 4,
                 .cache_read_cycles  = 4,
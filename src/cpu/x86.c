@@ -370,7 +370,7 @@ reset_common(int hard)
     if (!is286)
         reset_808x(hard);
 
-    mxcsr   = 0x1f80;
+    cpu_set_mxcsr(0x1f80);
     in_lock = 0;
 
     cpu_cpurst_on_sr = 0;
@@ -48,6 +48,7 @@ extern int x86_was_reset;
 extern int trap;
 extern int codegen_flat_ss;
 extern int codegen_flat_ds;
+extern int codegen_default_mxcsr;
 extern int timetolive;
 extern int keyboardtimer;
 extern int trap;
@@ -126,7 +126,7 @@ sf_fx_save_stor_common(uint32_t fetchdat, int bits)
         }
 
         if ((cpu_features & CPU_FEATURE_SSE) && (cr4 & CR4_OSFXSR)) {
-            mxcsr = readmeml(easeg, cpu_state.eaaddr + 24) & 0xffbf;
+            cpu_set_mxcsr(readmeml(easeg, cpu_state.eaaddr + 24) & 0xffbf);
             XMM[0].q[0] = readmemq(easeg, cpu_state.eaaddr + 0xa0);
             XMM[0].q[1] = readmemq(easeg, cpu_state.eaaddr + 0xa8);
             XMM[1].q[0] = readmemq(easeg, cpu_state.eaaddr + 0xb0);
@@ -240,7 +240,7 @@ sf_fx_save_stor_common(uint32_t fetchdat, int bits)
         if(src & ~mxcsr_mask)
             x86gpf(NULL, 0);
 #endif
-        mxcsr = src & mxcsr_mask;
+        cpu_set_mxcsr(src & mxcsr_mask);
     } else if (fxinst == 3) {
         if (cpu_mod == 3) {
             x86illegal();
@@ -425,7 +425,7 @@ fx_save_stor_common(uint32_t fetchdat, int bits)
         x87_settag(rec_ftw);
 
         if ((cpu_features & CPU_FEATURE_SSE) && (cr4 & CR4_OSFXSR)) {
-            mxcsr = readmeml(easeg, cpu_state.eaaddr + 24) & 0xffbf;
+            cpu_set_mxcsr(readmeml(easeg, cpu_state.eaaddr + 24) & 0xffbf);
             XMM[0].q[0] = readmemq(easeg, cpu_state.eaaddr + 0xa0);
             XMM[0].q[1] = readmemq(easeg, cpu_state.eaaddr + 0xa8);
             XMM[1].q[0] = readmemq(easeg, cpu_state.eaaddr + 0xb0);
@@ -553,7 +553,7 @@ fx_save_stor_common(uint32_t fetchdat, int bits)
         if(src & ~mxcsr_mask)
             x86gpf(NULL, 0);
 #endif
-        mxcsr = src & mxcsr_mask;
+        cpu_set_mxcsr(src & mxcsr_mask);
     } else if (fxinst == 3) {
         if (cpu_mod == 3) {
             x86illegal();
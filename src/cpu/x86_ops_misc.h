@@ -710,7 +710,7 @@ opHLT(UNUSED(uint32_t fetchdat))
     if (smi_line)
         enter_smm_check(1);
     else if (!((cpu_state.flags & I_FLAG) && pic.int_pending)) {
-        CLOCK_CYCLES_ALWAYS(100);
+        CLOCK_CYCLES_ALWAYS(cpu_hlt_idle_cycles());
         if (!((cpu_state.flags & I_FLAG) && pic.int_pending))
             cpu_state.pc--;
     } else {
@@ -1,5 +1,6 @@
 #include <stdarg.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include <wchar.h>
@@ -20,6 +21,7 @@
 #include "softfloat3e/config.h"
 #include "softfloat3e/fpu_trans.h"
 #include "softfloat3e/specialize.h"
+#include "softfloat3e/primitives.h"
 #include <86box/plat_unused.h>
 
 uint32_t x87_pc_off;
@@ -265,6 +267,250 @@ i387cw_to_softfloat_status_word(uint16_t control_word)
     return status;
 }
 
+/* Host double fast path for the softfloat arithmetic. The host result is only
+   used when it is provably identical to what softfloat would return: both
+   operands convert exactly to normal (or zero) doubles, and the result is
+   exact, normal and fits the precision control, so no exception flag can be
+   raised and the rounding mode does not matter. Anything else falls back to
+   softfloat. The exactness checks need strict IEEE double arithmetic, so the
+   fast path is limited to hosts where that is the default. */
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || defined(_M_ARM64) || defined(__SSE2_MATH__)
+#    define X87_SF_FAST_HOST
+#endif
+
+uint64_t x87_sf_fast_hits[X87_SF_FAST_OPS];
+uint64_t x87_sf_fast_fallbacks[X87_SF_FAST_OPS];
+
+#ifdef X87_SF_FAST_HOST
+static __inline int
+sf_fast_to_double(extFloat80_t a, double *d)
+{
+    int32_t  exp = a.signExp & 0x7fff;
+    uint64_t bits;
+
+    if (!exp && !a.signif)
+        bits = 0;
+    else {
+        /* Unnormals and bits below double precision can not be converted. */
+        if (!(a.signif >> 63) || (a.signif & 0x7ff))
+            return 0;
+        exp += 1023 - 16383;
+        if ((exp < 1) || (exp > 2046))
+            return 0;
+        bits = ((uint64_t) exp << 52) | ((a.signif >> 11) & 0x000fffffffffffffULL);
+    }
+    bits |= (uint64_t) (a.signExp & 0x8000) << 48;
+    memcpy(d, &bits, 8);
+
+    return 1;
+}
+
+static __inline int
+sf_fast_from_double(double d, int allow_zero, const struct softfloat_status_t *status, extFloat80_t *r)
+{
+    uint64_t bits;
+    uint32_t exp;
+    uint64_t sig;
+
+    memcpy(&bits, &d, 8);
+    exp = (bits >> 52) & 0x7ff;
+
+    if (!exp) {
+        /* Denormals would have raised underflow. */
+        if (!allow_zero || (bits & 0x000fffffffffffffULL))
+            return 0;
+        r->signif  = 0;
+        r->signExp = (bits >> 48) & 0x8000;
+        return 1;
+    }
+    if (exp == 0x7ff)
+        return 0;
+
+    sig = (1ULL << 63) | ((bits & 0x000fffffffffffffULL) << 11);
+    /* With 24-bit precision control the result must also fit a single. */
+    if ((status->extF80_roundingPrecision == 32) && (sig & 0x000000ffffffffffULL))
+        return 0;
+
+    r->signif  = sig;
+    r->signExp = ((bits >> 48) & 0x8000) | (exp - 1023 + 16383);
+
+    return 1;
+}
+
+/* Number of bits between the highest and lowest set bit of a double's
+   significand, inclusive. The product of two significands is exactly
+   representable if the sum of their spans is 53 or less. */
+static __inline int
+sf_fast_span(double d)
+{
+    uint64_t bits;
+    uint64_t sig;
+
+    memcpy(&bits, &d, 8);
+    sig = (bits & 0x000fffffffffffffULL) | (1ULL << 52);
+
+    return softfloat_countLeadingZeros64(sig & -sig) - softfloat_countLeadingZeros64(sig) + 1;
+}
+
+static int
+sf_fast_add(extFloat80_t a, extFloat80_t b, int negate_b, const struct softfloat_status_t *status, extFloat80_t *r)
+{
+    double da;
+    double db;
+    double s;
+    double bv;
+    double av;
+
+    if (!sf_fast_to_double(a, &da) || !sf_fast_to_double(b, &db))
+        return 0;
+    if (negate_b)
+        db = -db;
+
+    s = da + db;
+
+    /* TwoSum, the sum is exact if the rounding error is zero. */
+    bv = s - da;
+    av = s - bv;
+    if (((da - av) + (db - bv)) != 0.0)
+        return 0;
+
+    /* The sign of an exact zero sum depends on the rounding mode. */
+    if ((s == 0.0) && (status->softfloat_roundingMode != softfloat_round_near_even))
+        return 0;
+
+    return sf_fast_from_double(s, 1, status, r);
+}
+
+static int
+sf_fast_mul(extFloat80_t a, extFloat80_t b, const struct softfloat_status_t *status, extFloat80_t *r)
+{
+    double da;
+    double db;
+
+    if (!sf_fast_to_double(a, &da) || !sf_fast_to_double(b, &db))
+        return 0;
+
+    if ((da == 0.0) || (db == 0.0))
+        return sf_fast_from_double(da * db, 1, status, r);
+
+    if ((sf_fast_span(da) + sf_fast_span(db)) > 53)
+        return 0;
+
+    return sf_fast_from_double(da * db, 0, status, r);
+}
+
+static int
+sf_fast_div(extFloat80_t a, extFloat80_t b, const struct softfloat_status_t *status, extFloat80_t *r)
+{
+    double da;
+    double db;
+    double q;
+
+    if (!sf_fast_to_double(a, &da) || !sf_fast_to_double(b, &db) || (db == 0.0))
+        return 0;
+
+    if (da == 0.0)
+        return sf_fast_from_double(da / db, 1, status, r);
+
+    /* The quotient is exact if multiplying it back, which the span check
+       guarantees to be exact itself, gives the dividend. */
+    q = da / db;
+    if ((q == 0.0) || ((sf_fast_span(q) + sf_fast_span(db)) > 53) || ((q * db) != da))
+        return 0;
+
+    return sf_fast_from_double(q, 0, status, r);
+}
+#endif
+
+extFloat80_t
+x87_sf_add(extFloat80_t a, extFloat80_t b, struct softfloat_status_t *status)
+{
+#ifdef X87_SF_FAST_HOST
+    extFloat80_t r;
+
+    if (fpu_softfloat_fast) {
+        if (sf_fast_add(a, b, 0, status, &r)) {
+            x87_sf_fast_hits[X87_SF_FAST_ADD]++;
+            return r;
+        }
+        x87_sf_fast_fallbacks[X87_SF_FAST_ADD]++;
+    }
+#endif
+
+    return extF80_add(a, b, status);
+}
+
+extFloat80_t
+x87_sf_sub(extFloat80_t a, extFloat80_t b, struct softfloat_status_t *status)
+{
+#ifdef X87_SF_FAST_HOST
+    extFloat80_t r;
+
+    if (fpu_softfloat_fast) {
+        if (sf_fast_add(a, b, 1, status, &r)) {
+            x87_sf_fast_hits[X87_SF_FAST_SUB]++;
+            return r;
+        }
+        x87_sf_fast_fallbacks[X87_SF_FAST_SUB]++;
+    }
+#endif
+
+    return extF80_sub(a, b, status);
+}
+
+extFloat80_t
+x87_sf_mul(extFloat80_t a, extFloat80_t b, struct softfloat_status_t *status)
+{
+#ifdef X87_SF_FAST_HOST
+    extFloat80_t r;
+
+    if (fpu_softfloat_fast) {
+        if (sf_fast_mul(a, b, status, &r)) {
+            x87_sf_fast_hits[X87_SF_FAST_MUL]++;
+            return r;
+        }
+        x87_sf_fast_fallbacks[X87_SF_FAST_MUL]++;
+    }
+#endif
+
+    return extF80_mul(a, b, status);
+}
+
+extFloat80_t
+x87_sf_div(extFloat80_t a, extFloat80_t b, struct softfloat_status_t *status)
+{
+#ifdef X87_SF_FAST_HOST
+    extFloat80_t r;
+
+    if (fpu_softfloat_fast) {
+        if (sf_fast_div(a, b, status, &r)) {
+            x87_sf_fast_hits[X87_SF_FAST_DIV]++;
+            return r;
+        }
+        x87_sf_fast_fallbacks[X87_SF_FAST_DIV]++;
+    }
+#endif
+
+    return extF80_div(a, b, status);
+}
+
+void
+x87_sf_fast_log_stats(void)
+{
+    static const char *names[X87_SF_FAST_OPS] = { "FADD", "FSUB", "FMUL", "FDIV" };
+
+    for (int c = 0; c < X87_SF_FAST_OPS; c++) {
+        uint64_t total = x87_sf_fast_hits[c] + x87_sf_fast_fallbacks[c];
+
+        if (total)
+            pclog("x87 fast path: %s %" PRIu64 " of %" PRIu64 " fell back to softfloat (%i%%)\n",
+                  names[c], x87_sf_fast_fallbacks[c], total, (int) ((x87_sf_fast_fallbacks[c] * 100) / total));
+    }
+
+    memset(x87_sf_fast_hits, 0, sizeof(x87_sf_fast_hits));
+    memset(x87_sf_fast_fallbacks, 0, sizeof(x87_sf_fast_fallbacks));
+}
+
 int
 FPU_status_word_flags_fpu_compare(int float_relation)
 {
@@ -153,6 +153,22 @@ int                   FPU_tagof(const extFloat80_t reg);
 uint8_t               pack_FPU_TW(uint16_t twd);
 uint16_t              unpack_FPU_TW(uint16_t tag_byte);
 
+enum {
+    X87_SF_FAST_ADD = 0,
+    X87_SF_FAST_SUB,
+    X87_SF_FAST_MUL,
+    X87_SF_FAST_DIV,
+    X87_SF_FAST_OPS
+};
+
+extern uint64_t x87_sf_fast_hits[X87_SF_FAST_OPS];
+extern uint64_t x87_sf_fast_fallbacks[X87_SF_FAST_OPS];
+
+extFloat80_t x87_sf_add(extFloat80_t a, extFloat80_t b, struct softfloat_status_t *status);
+extFloat80_t x87_sf_sub(extFloat80_t a, extFloat80_t b, struct softfloat_status_t *status);
+extFloat80_t x87_sf_mul(extFloat80_t a, extFloat80_t b, struct softfloat_status_t *status);
+extFloat80_t x87_sf_div(extFloat80_t a, extFloat80_t b, struct softfloat_status_t *status);
+
 static __inline uint16_t
 i387_get_control_word(void)
 {
@@ -19,7 +19,7 @@
         status = i387cw_to_softfloat_status_word(i387_get_control_word());                                                                         \
         a      = FPU_read_regi(0);                                                                                                                 \
         if (!is_nan)                                                                                                                               \
-            result = extF80_add(a, use_var, &status);                                                                                              \
+            result = x87_sf_add(a, use_var, &status);                                                                                              \
                                                                                                                                                    \
         if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))                                                                          \
             FPU_save_regi(result, 0);                                                                                                              \
@@ -49,7 +49,7 @@ next_ins:
         status = i387cw_to_softfloat_status_word(i387_get_control_word());                                                                         \
         a      = FPU_read_regi(0);                                                                                                                 \
         if (!is_nan) {                                                                                                                             \
-            result = extF80_div(a, use_var, &status);                                                                                              \
+            result = x87_sf_div(a, use_var, &status);                                                                                              \
         }                                                                                                                                          \
         if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))                                                                          \
             FPU_save_regi(result, 0);                                                                                                              \
@@ -79,7 +79,7 @@ next_ins:
         status = i387cw_to_softfloat_status_word(i387_get_control_word());                                                                         \
         a      = FPU_read_regi(0);                                                                                                                 \
         if (!is_nan) {                                                                                                                             \
-            result = extF80_div(use_var, a, &status);                                                                                              \
+            result = x87_sf_div(use_var, a, &status);                                                                                              \
         }                                                                                                                                          \
         if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))                                                                          \
             FPU_save_regi(result, 0);                                                                                                              \
@@ -109,7 +109,7 @@ next_ins:
         status = i387cw_to_softfloat_status_word(i387_get_control_word());                                                                         \
         a      = FPU_read_regi(0);                                                                                                                 \
         if (!is_nan) {                                                                                                                             \
-            result = extF80_mul(a, use_var, &status);                                                                                              \
+            result = x87_sf_mul(a, use_var, &status);                                                                                              \
         }                                                                                                                                          \
         if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))                                                                          \
             FPU_save_regi(result, 0);                                                                                                              \
@@ -139,7 +139,7 @@ next_ins:
         status = i387cw_to_softfloat_status_word(i387_get_control_word());                                                                         \
         a      = FPU_read_regi(0);                                                                                                                 \
         if (!is_nan)                                                                                                                               \
-            result = extF80_sub(a, use_var, &status);                                                                                              \
+            result = x87_sf_sub(a, use_var, &status);                                                                                              \
                                                                                                                                                    \
         if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))                                                                          \
             FPU_save_regi(result, 0);                                                                                                              \
@@ -169,7 +169,7 @@ next_ins:
         status = i387cw_to_softfloat_status_word(i387_get_control_word());                                                                         \
         a      = FPU_read_regi(0);                                                                                                                 \
         if (!is_nan)                                                                                                                               \
-            result = extF80_sub(use_var, a, &status);                                                                                              \
+            result = x87_sf_sub(use_var, a, &status);                                                                                              \
                                                                                                                                                    \
         if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))                                                                          \
             FPU_save_regi(result, 0);                                                                                                              \
@@ -218,7 +218,7 @@ static int sf_FADD_st0_stj(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(0);
     b      = FPU_read_regi(fetchdat & 7);
-    result = extF80_add(a, b, &status);
+    result = x87_sf_add(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))
         FPU_save_regi(result, 0);
@@ -247,7 +247,7 @@ sf_FADD_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(fetchdat & 7);
     b      = FPU_read_regi(0);
-    result = extF80_add(a, b, &status);
+    result = x87_sf_add(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))
         FPU_save_regi(result, fetchdat & 7);
@@ -277,7 +277,7 @@ sf_FADDP_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(fetchdat & 7);
     b      = FPU_read_regi(0);
-    result = extF80_add(a, b, &status);
+    result = x87_sf_add(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, fetchdat & 7);
@@ -309,7 +309,7 @@ sf_FDIV_st0_stj(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(0);
     b      = FPU_read_regi(fetchdat & 7);
-    result = extF80_div(a, b, &status);
+    result = x87_sf_div(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))
         FPU_save_regi(result, 0);
@@ -339,7 +339,7 @@ sf_FDIV_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(fetchdat & 7);
     b      = FPU_read_regi(0);
-    result = extF80_div(a, b, &status);
+    result = x87_sf_div(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))
         FPU_save_regi(result, fetchdat & 7);
@@ -368,7 +368,7 @@ sf_FDIVP_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(fetchdat & 7);
     b      = FPU_read_regi(0);
-    result = extF80_div(a, b, &status);
+    result = x87_sf_div(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, fetchdat & 7);
@@ -400,7 +400,7 @@ sf_FDIVR_st0_stj(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(fetchdat & 7);
     b      = FPU_read_regi(0);
-    result = extF80_div(a, b, &status);
+    result = x87_sf_div(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))
         FPU_save_regi(result, 0);
@@ -429,7 +429,7 @@ sf_FDIVR_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(0);
     b      = FPU_read_regi(fetchdat & 7);
-    result = extF80_div(a, b, &status);
+    result = x87_sf_div(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0))
         FPU_save_regi(result, fetchdat & 7);
@@ -458,7 +458,7 @@ sf_FDIVRP_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(0);
     b      = FPU_read_regi(fetchdat & 7);
-    result = extF80_div(a, b, &status);
+    result = x87_sf_div(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, fetchdat & 7);
@@ -490,7 +490,7 @@ sf_FMUL_st0_stj(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(0);
     b      = FPU_read_regi(fetchdat & 7);
-    result = extF80_mul(a, b, &status);
+    result = x87_sf_mul(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, 0);
@@ -520,7 +520,7 @@ sf_FMUL_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(0);
     b      = FPU_read_regi(fetchdat & 7);
-    result = extF80_mul(a, b, &status);
+    result = x87_sf_mul(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, fetchdat & 7);
@@ -550,7 +550,7 @@ sf_FMULP_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(fetchdat & 7);
     b      = FPU_read_regi(0);
-    result = extF80_mul(a, b, &status);
+    result = x87_sf_mul(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, fetchdat & 7);
@@ -582,7 +582,7 @@ sf_FSUB_st0_stj(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(0);
     b      = FPU_read_regi(fetchdat & 7);
-    result = extF80_sub(a, b, &status);
+    result = x87_sf_sub(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, 0);
@@ -612,7 +612,7 @@ sf_FSUB_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(fetchdat & 7);
     b      = FPU_read_regi(0);
-    result = extF80_sub(a, b, &status);
+    result = x87_sf_sub(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, fetchdat & 7);
@@ -642,7 +642,7 @@ sf_FSUBP_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(fetchdat & 7);
     b      = FPU_read_regi(0);
-    result = extF80_sub(a, b, &status);
+    result = x87_sf_sub(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, fetchdat & 7);
@@ -674,7 +674,7 @@ sf_FSUBR_st0_stj(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(fetchdat & 7);
     b      = FPU_read_regi(0);
-    result = extF80_sub(a, b, &status);
+    result = x87_sf_sub(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, 0);
@@ -704,7 +704,7 @@ sf_FSUBR_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(0);
     b      = FPU_read_regi(fetchdat & 7);
-    result = extF80_sub(a, b, &status);
+    result = x87_sf_sub(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, fetchdat & 7);
@@ -734,7 +734,7 @@ sf_FSUBRP_sti_st0(uint32_t fetchdat)
     status = i387cw_to_softfloat_status_word(i387_get_control_word());
     a      = FPU_read_regi(0);
     b      = FPU_read_regi(fetchdat & 7);
-    result = extF80_sub(a, b, &status);
+    result = x87_sf_sub(a, b, &status);
 
     if (!FPU_exception(fetchdat, status.softfloat_exceptionFlags, 0)) {
         FPU_save_regi(result, fetchdat & 7);
@@ -35,6 +35,7 @@
 uint16_t     scancode_map[768] = { 0 };
 
 int          keyboard_scan;
+uint32_t     keyboard_input_events;
 
 #ifdef ENABLE_KBC_AT_LOG
 int kbc_at_do_log = ENABLE_KBC_AT_LOG;
@@ -243,6 +244,8 @@ keyboard_input(int down, uint16_t scan)
     if (kbd_in_reset)
         return;
 
+    keyboard_input_events++;
+
     /* Special case for E1 1D, translate it to 0100 - special case. */
     if ((scan >> 8) == 0xe1) {
         if ((scan & 0xff) == 0x1d)
@@ -662,7 +662,7 @@ gdbstub_client_write_reg(int index, uint8_t *buf)
             break;
 
         case GDB_REG_MXCSR:
-            mxcsr = *((uint32_t *) buf);
+            cpu_set_mxcsr(*((uint32_t *) buf));
             break;
 
         default:
@@ -94,6 +94,7 @@ extern int video_fps; /* (O) render speed in fps */
 #endif
 extern int settings_only;     /* (O) show only the settings dialog */
 extern int confirm_exit_cmdl; /* (O) do not ask for confirmation on quit if set to 0 */
+extern int turbo_mode;        /* (O) run as fast as the host allows */
 #ifdef _WIN32
 extern uint64_t unique_id;
 extern uint64_t source_hwnd;
@@ -144,8 +145,17 @@ extern uint32_t mem_size;                   /* (C) memory size (Installed on sys
 extern uint32_t isa_mem_size;               /* (C) memory size (ISA Memory Cards) */
 extern int      cpu;                        /* (C) cpu type */
 extern int      cpu_use_dynarec;            /* (C) cpu uses/needs Dyna */
+extern int      cpu_dynarec_hint_cache;     /* (C) remember which dynarec blocks were recompiled across runs */
+extern int      cpu_dynarec_threshold;      /* (C) interpreted runs before a block is recompiled */
+extern int      cpu_dynarec_hot_threshold;  /* (C) runs before a block is recompiled as hot, 0 = never */
+extern int      cpu_808x_fast;              /* (C) 808x uses batched cycle accounting */
+extern int      cpu_tlb_size;               /* (C) software TLB entries, 0 = default */
+extern int      mem_ksm;                    /* (C) let the host merge identical guest RAM pages */
+extern int      rivatimer_emulated;         /* (C) rivatimers run in emulated time */
+extern int      cpu_hlt_skip;               /* (C) halted cpu skips ahead to the next timer */
 extern int      fpu_type;                   /* (C) fpu type */
 extern int      fpu_softfloat;              /* (C) fpu uses softfloat */
+extern int      fpu_softfloat_fast;         /* (C) softfloat uses the host FPU when the result is exact */
 extern int      time_sync;                  /* (C) enable time sync */
 extern int      hdd_format_type;            /* (C) hard disk file format */
 extern int      lba_enhancer_enabled;       /* (C) enable Vision Systems LBA Enhancer */
@@ -214,11 +224,23 @@ extern void pc_send_cad(void);
 extern void pc_send_cae(void);
 extern void pc_send_cab(void);
 extern void pc_run(void);
+extern int  pc_slice_next(void);
+extern void pc_slice_done(uint64_t host_us);
 extern void pc_start(void);
 extern void pc_onesec(void);
 
 extern uint16_t get_last_addr(void);
 
+/* Main loop time slicing, in microseconds. */
+#define PC_SLICE_MIN_US  5000   /* while there is user input */
+#define PC_SLICE_US      10000  /* while sound is playing */
+#define PC_SLICE_MAX_US  20000  /* nothing latency-sensitive */
+#define PC_SLICE_LATE_US 50000  /* give up catching up beyond this */
+#define PC_INPUT_HOLD_US 250000 /* keep short slices this long after input */
+
+extern int      pc_slice_us;      /* length of the current slice */
+extern uint64_t pc_slice_host_us; /* host time taken by the last slice */
+
 /* This is for external subtraction of cycles;
    should be in cpu.c but I put it here to avoid
    having to include cpu.h everywhere. */
@@ -196,6 +196,7 @@ extern "C" {
 
 extern uint8_t keyboard_mode;
 extern int     keyboard_scan;
+extern uint32_t keyboard_input_events;
 
 extern uint16_t scancode_map[768];
 
@@ -196,8 +196,32 @@ typedef struct _mem_mapping_ {
     /* There is never a needed to pass a pointer to the mapping itself, it is much preferable to
        prepare a structure with the requires data (usually, the base address and mask) instead. */
     void *priv; /* backpointer to device */
+
+    /* Private to mem.c: position in the mapping list, and where the mapping
+       is linked into the address index used by mem_mapping_recalc(). */
+    uint32_t seq;
+    uint32_t stamp;
+    uint8_t  indexed;
+    uint16_t index_first;
+    uint16_t index_last;
 } mem_mapping_t;
 
+/* Host memory used by the emulated machine's memory, in bytes. */
+typedef struct mem_usage_t {
+    uint64_t ram_size;      /* guest RAM reserved */
+    uint64_t ram_resident;  /* guest RAM actually backed by host memory */
+    uint64_t meta_size;     /* page table and dirty masks reserved */
+    uint64_t meta_resident; /* page table and dirty masks actually backed */
+} mem_usage_t;
+
+/* Guest RAM pages that could be shared with other pages, from mem_dedup_scan(). */
+typedef struct mem_dedup_t {
+    uint32_t pages;        /* pages scanned */
+    uint32_t zero_pages;   /* pages containing only zeroes */
+    uint32_t unique_pages; /* distinct contents among the other pages */
+    uint32_t dup_pages;    /* pages identical to one of the unique pages */
+} mem_dedup_t;
+
 #ifdef USE_NEW_DYNAREC
 extern uint64_t *byte_dirty_mask;
 extern uint64_t *byte_code_present_mask;
@@ -264,14 +288,10 @@ extern uint8_t *rom;
 extern uint32_t biosmask;
 extern uint32_t biosaddr;
 
-extern int        readlookup[256];
 extern uintptr_t *readlookup2;
 extern uintptr_t  old_rl2;
 extern uint8_t    uncached;
-extern int        readlnext;
-extern int        writelookup[256];
 extern uintptr_t *writelookup2;
-extern int        writelnext;
 extern uint32_t   ram_mapped_addr[64];
 extern uint8_t    page_ff[4096];
 
@@ -298,6 +318,11 @@ extern int shadowbios_write;
 extern int readlnum;
 extern int writelnum;
 
+extern uint64_t mem_tlb_hits;
+extern uint64_t mem_tlb_misses;
+extern uint64_t mem_tlb_evictions;
+extern uint64_t mem_tlb_flushes;
+
 extern int memspeed[11];
 
 extern uint8_t high_page; /* if a high (> 4 gb) page was detected */
@@ -352,6 +377,10 @@ extern void     writememll_no_mmut_2386(uint32_t addr, uint32_t *a64, uint32_t v
 
 extern void     do_mmutranslate_2386(uint32_t addr, uint32_t *a64, int num, int write);
 
+extern uint32_t pccache_2386;
+extern uint8_t *pccache2_2386;
+extern void     pccache_fill_2386(uint32_t addr, uint32_t phys);
+
 extern uint8_t *getpccache(uint32_t a);
 extern uint64_t mmutranslatereal(uint32_t addr, int rw);
 extern uint32_t mmutranslatereal32(uint32_t addr, int rw);
@@ -418,6 +447,8 @@ extern void     mem_writeb_phys(uint32_t addr, uint8_t val);
 extern void     mem_writew_phys(uint32_t addr, uint16_t val);
 extern void     mem_writel_phys(uint32_t addr, uint32_t val);
 extern void     mem_write_phys(void *src, uint32_t addr, int tranfer_size);
+extern void     mem_read_phys_block(void *dest, uint32_t addr, uint32_t size, int transfer_size);
+extern void     mem_write_phys_block(const void *src, uint32_t addr, uint32_t size, int transfer_size);
 
 extern uint8_t  mem_read_ram(uint32_t addr, void *priv);
 extern uint16_t mem_read_ramw(uint32_t addr, void *priv);
@@ -447,6 +478,7 @@ extern void mem_flush_write_page(uint32_t addr, uint32_t virt);
 extern void mem_reset_page_blocks(void);
 
 extern void flushmmucache(void);
+extern void flushmmucache_cr3(void);
 extern void flushmmucache_write(void);
 extern void flushmmucache_pc(void);
 extern void flushmmucache_nopc(void);
@@ -460,6 +492,8 @@ extern void mem_init(void);
 extern void mem_close(void);
 extern void mem_zero(void);
 extern void mem_reset(void);
+extern void mem_get_usage(mem_usage_t *usage);
+extern void mem_dedup_scan(mem_dedup_t *dedup);
 extern void mem_remap_top_ex(int kb, uint32_t start);
 extern void mem_remap_top_ex_nomid(int kb, uint32_t start);
 extern void mem_remap_top(int kb);
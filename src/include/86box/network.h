@@ -46,6 +46,12 @@
 #ifndef EMU_NETWORK_H
 #define EMU_NETWORK_H
 #include <stdint.h>
+#ifdef __cplusplus
+#    include <atomic>
+using atomic_uint = std::atomic_uint;
+#else
+#    include <stdatomic.h>
+#endif
 
 /* Network provider types. */
 #define NET_TYPE_NONE  0 /* use the null network driver */
@@ -54,10 +60,11 @@
 #define NET_TYPE_VDE   3 /* use the VDE plug API */
 
 #define NET_MAX_FRAME  1518
-/* Queue size must be a power of 2 */
-#define NET_QUEUE_LEN      16
-#define NET_QUEUE_LEN_MASK (NET_QUEUE_LEN - 1)
-#define NET_QUEUE_COUNT    4
+/* Queue sizes must be a power of 2 */
+#define NET_QUEUE_LEN      64 /* default depth, also the backends' batch size */
+#define NET_QUEUE_LEN_MIN  16
+#define NET_QUEUE_LEN_MAX  1024
+#define NET_QUEUE_COUNT    5
 #define NET_CARD_MAX       4
 #define NET_HOST_INTF_MAX  64
 
@@ -87,7 +94,8 @@ enum {
     NET_QUEUE_RX       = 0,
     NET_QUEUE_TX_VM    = 1,
     NET_QUEUE_TX_HOST  = 2,
-    NET_QUEUE_RX_ON_TX = 3
+    NET_QUEUE_RX_ON_TX = 3,
+    NET_QUEUE_RX_VM    = 4
 };
 
 typedef struct netcard_conf_t {
@@ -95,6 +103,7 @@ typedef struct netcard_conf_t {
     int      net_type;
     char     host_dev_name[128];
     uint32_t link_state;
+    uint32_t queue_len;
 } netcard_conf_t;
 
 extern netcard_conf_t net_cards_conf[NET_CARD_MAX];
@@ -108,10 +117,15 @@ typedef struct netpkt {
     int      len;
 } netpkt_t;
 
+/* Single producer, single consumer ring. The indices run freely and are
+   masked on access; head is only written by the producer and tail only by
+   the consumer. */
 typedef struct netqueue_t {
-    netpkt_t packets[NET_QUEUE_LEN];
-    int      head;
-    int      tail;
+    netpkt_t   *packets;
+    uint32_t    size;
+    uint32_t    mask;
+    atomic_uint head;
+    atomic_uint tail;
 } netqueue_t;
 
 typedef struct _netcard_t netcard_t;
@@ -135,9 +149,6 @@ struct _netcard_t {
     NETRXCB         rx;
     NETSETLINKSTATE set_link_state;
     netqueue_t      queues[NET_QUEUE_COUNT];
-    netpkt_t        queued_pkt;
-    mutex_t        *tx_mutex;
-    mutex_t        *rx_mutex;
     pc_timer_t      timer;
     uint16_t        card_num;
     double          byte_period;
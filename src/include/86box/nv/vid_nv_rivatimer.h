@@ -40,6 +40,11 @@ NV20 (2001)     GeForce 3       Programmable shaders!
 As you can see, the performance basically exponentially increases over a period of only 4 years. 
 
 So I decided to create this timer that is completely separate from the CPU Core.
+
+Timers run off the host's monotonic clock by default. Running timers are also kept in a queue ordered by deadline, so the main loop 
+can split its CPU slice and service them with sub-millisecond precision (see pc_run). If rivatimer_emulated is set, the clock 
+instead advances with emulated time, which keeps the card deterministic and in step with the guest when it runs slower or faster 
+than real time.
 */
 
 #pragma once
@@ -64,19 +69,25 @@ typedef struct rivatimer_s
     bool                    running;        // Is this RivaTimer running?
     struct rivatimer_s*     next;           // Next RivaTimer
     void                    (*callback)(double real_time);  // Callback to call on fire
-    #ifdef _WIN32
-    LARGE_INTEGER           starting_time;  // Starting time.
-    #else
-    struct timespec         starting_time;  // Starting time.
-    #endif
+    double                  starting_time;  // Time of the last firing (or of the start) in uS.
+    double                  deadline;       // Time in uS at which the timer is next due to fire.
+    struct rivatimer_s*     queue_prev;     // Previous running RivaTimer in deadline order
+    struct rivatimer_s*     queue_next;     // Next running RivaTimer in deadline order
     double                  time;           // Accumulated time in uS.
 } rivatimer_t;
 
+// Shortest CPU slice the main loop will run between two rivatimer updates, in uS. Timers with a shorter period don't split 
+// the slice at all and fire once per slice.
+#define RIVATIMER_SLICE_MIN_US  100
+
 void rivatimer_init(void);                                              // Initialise the Rivatimer.
 rivatimer_t* rivatimer_create(double period, void (*callback)(double real_time));
 void rivatimer_destroy(rivatimer_t* rivatimer_ptr);
 
 void rivatimer_update_all(void);
+double rivatimer_next_deadline(void);                                   // uS until the next timer of at least RIVATIMER_SLICE_MIN_US is due, < 0 if none.
+void rivatimer_advance(double microseconds);                            // Advance the emulated clock.
+double rivatimer_get_clock(void);                                       // Current rivatimer clock in uS.
 void rivatimer_start(rivatimer_t* rivatimer_ptr);
 void rivatimer_stop(rivatimer_t* rivatimer_ptr);
 double rivatimer_get_time(rivatimer_t* rivatimer_ptr);
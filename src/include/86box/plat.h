@@ -151,6 +151,10 @@ extern int      plat_dir_check(char *path);
 extern int      plat_dir_create(char *path);
 extern void    *plat_mmap(size_t size, uint8_t executable);
 extern void     plat_munmap(void *ptr, size_t size);
+extern void     plat_mmap_hugepages(void *ptr, size_t size);
+extern void     plat_mmap_mergeable(void *ptr, size_t size);
+extern void    *plat_mmap_file(FILE *fp, size_t offset, size_t size);
+extern size_t   plat_mresident(void *ptr, size_t size);
 extern uint64_t plat_timer_read(void);
 extern uint32_t plat_get_ticks(void);
 extern void     plat_delay_ms(uint32_t count);
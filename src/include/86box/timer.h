@@ -50,8 +50,9 @@ typedef struct pc_timer_t {
     void (*callback)(void *priv);
     void *priv;
 
-    struct pc_timer_t *prev;
-    struct pc_timer_t *next;
+    uint32_t seq;      /* When the timer was last enabled, to order timers
+                          that expire at the same time. */
+    int      heap_pos; /* Position in the timer heap while enabled. */
 } pc_timer_t;
 
 #ifdef __cplusplus
@@ -69,6 +70,8 @@ extern void timer_disable(pc_timer_t *timer);
 
 /*Process any pending timers*/
 extern void timer_process(void);
+/*Is any timer enabled? If not, timer_target is stale*/
+extern int timer_pending(void);
 
 /*Reset timer system*/
 extern void timer_close(void);
@@ -143,6 +143,9 @@ typedef struct monitor_settings_t {
 } monitor_settings_t;
 
 #define MONITORS_NUM 2
+
+/* Display rate in turbo mode. */
+#define TURBO_FPS 30
 extern monitor_t          monitors[MONITORS_NUM];
 extern monitor_settings_t monitor_settings[MONITORS_NUM];
 extern atomic_bool        doresize_monitors[MONITORS_NUM];
@@ -38,6 +38,7 @@
 #include <86box/plat.h>
 #include <86box/rom.h>
 #include <86box/gdbstub.h>
+#include <86box/plat_unused.h>
 #ifdef USE_DYNAREC
 #    include "codegen_public.h"
 #else
@@ -83,13 +84,13 @@ uint32_t biosaddr;
 uint32_t pccache;
 uint8_t *pccache2;
 
-int        readlnext;
-int        readlookup[256];
+/* Code fetch cache for the 286/386 interpreter, see pccache_fill_2386(). */
+uint32_t pccache_2386  = 0xffffffff;
+uint8_t *pccache2_2386 = NULL;
+
 uintptr_t *readlookup2;
 uintptr_t  old_rl2;
 uint8_t    uncached = 0;
-int        writelnext;
-int        writelookup[256];
 uintptr_t *writelookup2;
 
 uint32_t mem_logical_addr;
@@ -98,7 +99,6 @@ int shadowbios = 0;
 int shadowbios_write;
 int readlnum  = 0;
 int writelnum = 0;
-int cachesize = 256;
 
 uint32_t get_phys_virt;
 uint32_t get_phys_phys;
@@ -113,6 +113,8 @@ int mmuflush = 0;
 uint64_t *byte_dirty_mask;
 uint64_t *byte_code_present_mask;
 
+static size_t byte_mask_size;
+
 uint32_t purgable_page_list_head = 0;
 int      purgeable_page_count    = 0;
 #endif
@@ -126,6 +128,8 @@ uint8_t              *_mem_exec[MEM_MAPPINGS_NO];
 
 static mem_mapping_t *base_mapping;
 static mem_mapping_t *last_mapping;
+static uint32_t       mapping_seq;
+static uint32_t       mapping_count;
 static mem_mapping_t *read_mapping_bus[MEM_MAPPINGS_NO];
 static mem_mapping_t *write_mapping_bus[MEM_MAPPINGS_NO];
 static uint8_t       _mem_wp[MEM_MAPPINGS_NO];
@@ -168,48 +172,250 @@ mem_addr_is_ram(uint32_t addr)
            (mapping == &ram_mid_mapping2) || (mapping == &ram_remapped_mapping);
 }
 
+/* Software TLB. Each entry caches the translation of one virtual page for
+   mmutranslatereal(), and records whether readlookup2[], writelookup2[] or
+   page_lookup[] hold a direct pointer for that page, so that those get
+   invalidated along with the entry. The TLB is set-associative, indexed by
+   the virtual page, with cpu_tlb_size entries in sets of MEM_TLB_WAYS.
+
+   Entries for global pages (with CR4.PGE set) are kept across CR3 writes,
+   everything else is dropped then, as the guest relies on that to flush its
+   page table changes. */
+#define MEM_TLB_WAYS         4
+#define MEM_TLB_SIZE_DEFAULT 1024
+#define MEM_TLB_SIZE_MIN     256
+#define MEM_TLB_SIZE_MAX     65536
+#define MEM_TLB_FREE         0xffffffff
+
+#define MEM_TLB_XLAT         0x01 /* translation usable by mmutranslatereal() */
+#define MEM_TLB_USER         0x02
+#define MEM_TLB_WRITABLE     0x04
+#define MEM_TLB_DIRTY        0x08
+#define MEM_TLB_GLOBAL       0x10
+#define MEM_TLB_READ         0x20 /* readlookup2[] points at the page */
+#define MEM_TLB_WRITE        0x40 /* writelookup2[] or page_lookup[] points at the page */
+
+typedef struct mem_tlb_entry_t {
+    uint32_t virt; /* virtual page, or MEM_TLB_FREE */
+    uint32_t xlat; /* physical page the translation gives */
+    uint32_t phys; /* physical page behind the direct pointers */
+    uint32_t live; /* position in tlb_live[] */
+    uint8_t  flags;
+} mem_tlb_entry_t;
+
+static mem_tlb_entry_t *tlb;
+static uint32_t        *tlb_live;
+static uint32_t         tlb_live_nr;
+static uint8_t         *tlb_next_way;
+static uint32_t         tlb_size;
+static uint32_t         tlb_sets_mask;
+static uint8_t          mmu_walk_flags;
+
+uint64_t mem_tlb_hits;
+uint64_t mem_tlb_misses;
+uint64_t mem_tlb_evictions;
+uint64_t mem_tlb_flushes;
+
+static void
+mem_tlb_alloc(void)
+{
+    uint32_t size = cpu_tlb_size ? cpu_tlb_size : MEM_TLB_SIZE_DEFAULT;
+
+    if (size < MEM_TLB_SIZE_MIN)
+        size = MEM_TLB_SIZE_MIN;
+    else if (size > MEM_TLB_SIZE_MAX)
+        size = MEM_TLB_SIZE_MAX;
+    /* Round down to a power of two. */
+    while (size & (size - 1))
+        size &= size - 1;
+
+    if (size != tlb_size) {
+        free(tlb);
+        free(tlb_live);
+        free(tlb_next_way);
+
+        tlb_size      = size;
+        tlb_sets_mask = (size / MEM_TLB_WAYS) - 1;
+        tlb           = (mem_tlb_entry_t *) malloc(size * sizeof(mem_tlb_entry_t));
+        tlb_live      = (uint32_t *) malloc(size * sizeof(uint32_t));
+        tlb_next_way  = (uint8_t *) malloc(size / MEM_TLB_WAYS);
+    }
+
+    for (uint32_t c = 0; c < tlb_size; c++) {
+        tlb[c].virt  = MEM_TLB_FREE;
+        tlb[c].flags = 0;
+    }
+    memset(tlb_next_way, 0x00, tlb_size / MEM_TLB_WAYS);
+    tlb_live_nr = 0;
+}
+
+static __inline mem_tlb_entry_t *
+mem_tlb_set(uint32_t virt)
+{
+    return &tlb[((virt ^ (virt >> 8)) & tlb_sets_mask) * MEM_TLB_WAYS];
+}
+
+static __inline mem_tlb_entry_t *
+mem_tlb_find(uint32_t virt)
+{
+    mem_tlb_entry_t *set = mem_tlb_set(virt);
+
+    for (int c = 0; c < MEM_TLB_WAYS; c++) {
+        if (set[c].virt == virt)
+            return &set[c];
+    }
+
+    return NULL;
+}
+
+static void
+mem_tlb_drop_views(mem_tlb_entry_t *entry, uint8_t views)
+{
+    views &= entry->flags;
+
+    if (views & MEM_TLB_READ)
+        readlookup2[entry->virt] = LOOKUP_INV;
+    if (views & MEM_TLB_WRITE) {
+        page_lookup[entry->virt]  = NULL;
+        writelookup2[entry->virt] = LOOKUP_INV;
+    }
+
+    entry->flags &= ~views;
+}
+
+static void
+mem_tlb_free(mem_tlb_entry_t *entry)
+{
+    uint32_t last;
+
+    mem_tlb_drop_views(entry, MEM_TLB_READ | MEM_TLB_WRITE);
+    entry->virt  = MEM_TLB_FREE;
+    entry->flags = 0;
+
+    last                  = tlb_live[--tlb_live_nr];
+    tlb_live[entry->live] = last;
+    tlb[last].live        = entry->live;
+}
+
+/* Returns the entry for a virtual page, evicting another one from its set if
+   needed. */
+static mem_tlb_entry_t *
+mem_tlb_get(uint32_t virt)
+{
+    mem_tlb_entry_t *set   = mem_tlb_set(virt);
+    mem_tlb_entry_t *entry = NULL;
+    uint32_t         way;
+
+    for (int c = 0; c < MEM_TLB_WAYS; c++) {
+        if (set[c].virt == virt)
+            return &set[c];
+        if ((entry == NULL) && (set[c].virt == MEM_TLB_FREE))
+            entry = &set[c];
+    }
+
+    if (entry == NULL) {
+        way   = tlb_next_way[(set - tlb) / MEM_TLB_WAYS]++;
+        entry = &set[way & (MEM_TLB_WAYS - 1)];
+        if ((entry->virt == ((es + DI) >> 12)) || (entry->virt == ((es + EDI) >> 12)))
+            uncached = 1;
+        mem_tlb_free(entry);
+        mem_tlb_evictions++;
+    }
+
+    entry->virt             = virt;
+    entry->flags            = 0;
+    entry->live             = tlb_live_nr;
+    tlb_live[tlb_live_nr++] = entry - tlb;
+
+    return entry;
+}
+
+/* Drops the given direct pointers from every entry matching the physical page
+   range, and the entries left with nothing in them. */
+static void
+mem_tlb_drop_views_phys(uint8_t views, uint32_t first, uint32_t last)
+{
+    uint32_t c = 0;
+
+    while (c < tlb_live_nr) {
+        mem_tlb_entry_t *entry = &tlb[tlb_live[c]];
+
+        if ((entry->flags & views) && (entry->phys >= first) && (entry->phys <= last)) {
+            mem_tlb_drop_views(entry, views);
+            if (!entry->flags) {
+                mem_tlb_free(entry);
+                continue;
+            }
+        }
+        c++;
+    }
+}
+
+static void
+mem_tlb_flush(int keep_global)
+{
+    uint32_t c = 0;
+
+    while (c < tlb_live_nr) {
+        mem_tlb_entry_t *entry = &tlb[tlb_live[c]];
+
+        if (keep_global && (entry->flags & MEM_TLB_GLOBAL))
+            c++;
+        else
+            mem_tlb_free(entry);
+    }
+
+    /* Also the generation that dynarec block links are checked against. */
+    mem_tlb_flushes++;
+}
+
 void
 resetreadlookup(void)
 {
     /* Initialize the page lookup table. */
     memset(page_lookup, 0x00, (1 << 20) * sizeof(page_t *));
 
-    /* Initialize the tables for lower (<= 1024K) RAM. */
-    for (uint16_t c = 0; c < 256; c++) {
-        readlookup[c]  = 0xffffffff;
-        writelookup[c] = 0xffffffff;
-    }
-
     /* Initialize the tables for high (> 1024K) RAM. */
     memset(readlookup2, 0xff, (1 << 20) * sizeof(uintptr_t));
 
     memset(writelookup2, 0xff, (1 << 20) * sizeof(uintptr_t));
 
-    readlnext  = 0;
-    writelnext = 0;
-    pccache    = 0xffffffff;
-    high_page  = 0;
+    mem_tlb_alloc();
+
+    pccache   = 0xffffffff;
+    high_page = 0;
+
+    pccache_2386 = 0xffffffff;
 }
 
 void
 flushmmucache(void)
 {
-    for (uint16_t c = 0; c < 256; c++) {
-        if (readlookup[c] != (int) 0xffffffff) {
-            readlookup2[readlookup[c]] = LOOKUP_INV;
-            readlookup[c]              = 0xffffffff;
-        }
-        if (writelookup[c] != (int) 0xffffffff) {
-            page_lookup[writelookup[c]]  = NULL;
-            writelookup2[writelookup[c]] = LOOKUP_INV;
-            writelookup[c]               = 0xffffffff;
-        }
-    }
+    mem_tlb_flush(0);
+    mmuflush++;
+
+    pccache  = (uint32_t) 0xffffffff;
+    pccache2 = (uint8_t *) 0xffffffff;
+
+    pccache_2386 = 0xffffffff;
+
+#ifdef USE_DYNAREC
+    codegen_flush();
+#endif
+}
+
+/* Flush for a CR3 write, keeping global pages. */
+void
+flushmmucache_cr3(void)
+{
+    mem_tlb_flush(!!(cr4 & CR4_PGE));
     mmuflush++;
 
     pccache  = (uint32_t) 0xffffffff;
     pccache2 = (uint8_t *) 0xffffffff;
 
+    pccache_2386 = 0xffffffff;
+
 #ifdef USE_DYNAREC
     codegen_flush();
 #endif
@@ -218,13 +424,7 @@ flushmmucache(void)
 void
 flushmmucache_write(void)
 {
-    for (uint16_t c = 0; c < 256; c++) {
-        if (writelookup[c] != (int) 0xffffffff) {
-            page_lookup[writelookup[c]]  = NULL;
-            writelookup2[writelookup[c]] = LOOKUP_INV;
-            writelookup[c]               = 0xffffffff;
-        }
-    }
+    mem_tlb_drop_views_phys(MEM_TLB_WRITE, 0, 0xffffffff);
     mmuflush++;
 }
 
@@ -236,6 +436,8 @@ flushmmucache_pc(void)
     pccache  = (uint32_t) 0xffffffff;
     pccache2 = (uint8_t *) 0xffffffff;
 
+    pccache_2386 = 0xffffffff;
+
 #ifdef USE_DYNAREC
     codegen_flush();
 #endif
@@ -244,48 +446,28 @@ flushmmucache_pc(void)
 void
 flushmmucache_nopc(void)
 {
-    for (uint16_t c = 0; c < 256; c++) {
-        if (readlookup[c] != (int) 0xffffffff) {
-            readlookup2[readlookup[c]] = LOOKUP_INV;
-            readlookup[c]              = 0xffffffff;
-        }
-        if (writelookup[c] != (int) 0xffffffff) {
-            page_lookup[writelookup[c]]  = NULL;
-            writelookup2[writelookup[c]] = LOOKUP_INV;
-            writelookup[c]               = 0xffffffff;
-        }
-    }
+    /* Also used for INVLPG and memory mapping changes, both of which can
+       change what a code page translates to. */
+    pccache_2386 = 0xffffffff;
+
+    mem_tlb_flush(0);
 }
 
-void
-mem_flush_write_page(uint32_t addr, uint32_t virt)
+/* Drop the cached translations to physical pages in the given range only,
+   for memory mapping changes that do not affect anything else. The
+   translations themselves stay valid, only the direct pointers go. */
+static void
+flushmmucache_phys(uint64_t base, uint64_t size)
 {
-    const page_t *page_target = &pages[addr >> 12];
-#if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
-    uint32_t a;
-#endif
+    pccache_2386 = 0xffffffff;
 
-    for (uint16_t c = 0; c < 256; c++) {
-        if (writelookup[c] != (int) 0xffffffff) {
-#if (defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64)
-            uintptr_t target = (uintptr_t) &ram[(uintptr_t) (addr & ~0xfff) - (virt & ~0xfff)];
-#else
-            a = (uintptr_t) (addr & ~0xfff) - (virt & ~0xfff);
-            uintptr_t target;
-
-            if ((addr & ~0xfff) >= (1 << 30))
-                target = (uintptr_t) &ram2[a - (1 << 30)];
-            else
-                target = (uintptr_t) &ram[a];
-#endif
+    mem_tlb_drop_views_phys(MEM_TLB_READ | MEM_TLB_WRITE, base >> 12, (base + size - 1) >> 12);
+}
 
-            if (writelookup2[writelookup[c]] == target || page_lookup[writelookup[c]] == page_target) {
-                writelookup2[writelookup[c]] = LOOKUP_INV;
-                page_lookup[writelookup[c]]  = NULL;
-                writelookup[c]               = 0xffffffff;
-            }
-        }
-    }
+void
+mem_flush_write_page(uint32_t addr, UNUSED(uint32_t virt))
+{
+    mem_tlb_drop_views_phys(MEM_TLB_WRITE, addr >> 12, addr >> 12);
 }
 
 #define mmutranslate_read(addr)  mmutranslatereal(addr, 0)
@@ -293,6 +475,45 @@ mem_flush_write_page(uint32_t addr, uint32_t virt)
 #define rammap(x)                ((uint32_t *) (_mem_exec[(x) >> MEM_GRANULARITY_BITS]))[((x) >> 2) & MEM_GRANULARITY_QMASK]
 #define rammap64(x)              ((uint64_t *) (_mem_exec[(x) >> MEM_GRANULARITY_BITS]))[((x) >> 3) & MEM_GRANULARITY_PMASK]
 
+/* TLB flags for a successful page walk, from the combined permissions of the
+   levels and the final level entry. */
+static __inline uint8_t
+mmu_tlb_flags(uint64_t perm, uint64_t entry, int rw)
+{
+    uint8_t flags = MEM_TLB_XLAT;
+
+    if (perm & 4)
+        flags |= MEM_TLB_USER;
+    if (perm & 2)
+        flags |= MEM_TLB_WRITABLE;
+    if (rw)
+        flags |= MEM_TLB_DIRTY;
+    if ((entry & 0x100) && (cr4 & CR4_PGE))
+        flags |= MEM_TLB_GLOBAL;
+
+    return flags;
+}
+
+/* Whether an access may use a TLB entry, the conditions are the same as for
+   a page fault in the page walk. A write to a page not yet marked dirty goes
+   through the page walk to set the dirty bit. */
+static __inline int
+mmu_tlb_allowed(uint8_t flags, int rw)
+{
+    if ((CPL == 3) && !(flags & MEM_TLB_USER) && !cpl_override)
+        return 0;
+
+    if (rw) {
+        if (!(flags & MEM_TLB_DIRTY))
+            return 0;
+        if (!cpl_override && !(flags & MEM_TLB_WRITABLE) &&
+            (((CPL == 3) && !cpl_override) || ((is486 || isibm486) && (cr0 & WP_FLAG))))
+            return 0;
+    }
+
+    return 1;
+}
+
 static __inline uint64_t
 mmutranslatereal_normal(uint32_t addr, int rw)
 {
@@ -334,6 +555,7 @@ mmutranslatereal_normal(uint32_t addr, int rw)
         }
 
         rammap(addr2) |= (rw ? 0x60 : 0x20);
+        mmu_walk_flags = mmu_tlb_flags(temp, temp, rw);
 
         uint64_t page = temp & ~0x3fffff;
         if (cpu_features & CPU_FEATURE_PSE36)
@@ -357,6 +579,7 @@ mmutranslatereal_normal(uint32_t addr, int rw)
 
     rammap(addr2) |= 0x20;
     rammap((temp2 & ~0xfff) + ((addr >> 10) & 0xffc)) |= (rw ? 0x60 : 0x20);
+    mmu_walk_flags = mmu_tlb_flags(temp3, temp, rw);
 
     return (uint64_t) ((temp & ~0xfff) + (addr & 0xfff));
 }
@@ -419,6 +642,7 @@ mmutranslatereal_pae(uint32_t addr, int rw)
             return 0xffffffffffffffffULL;
         }
         rammap64(addr3) |= (rw ? 0x60 : 0x20);
+        mmu_walk_flags = mmu_tlb_flags(temp, temp, rw);
 
         return ((temp & ~0x1fffffULL) + (addr & 0x1fffffULL)) & 0x000000ffffffffffULL;
     }
@@ -440,6 +664,7 @@ mmutranslatereal_pae(uint32_t addr, int rw)
 
     rammap64(addr3) |= 0x20;
     rammap64(addr4) |= (rw ? 0x60 : 0x20);
+    mmu_walk_flags = mmu_tlb_flags(temp3, temp, rw);
 
     return ((temp & ~0xfffULL) + ((uint64_t) (addr & 0xfff))) & 0x000000ffffffffffULL;
 }
@@ -447,14 +672,33 @@ mmutranslatereal_pae(uint32_t addr, int rw)
 uint64_t
 mmutranslatereal(uint32_t addr, int rw)
 {
+    mem_tlb_entry_t *entry;
+    uint64_t         phys;
+
     /* Fast path to return invalid without any call if an exception has occurred beforehand. */
     if (cpu_state.abrt)
         return 0xffffffffffffffffULL;
 
+    entry = mem_tlb_find(addr >> 12);
+    if ((entry != NULL) && (entry->flags & MEM_TLB_XLAT) && mmu_tlb_allowed(entry->flags, rw)) {
+        mem_tlb_hits++;
+        return ((uint64_t) entry->xlat << 12) | (addr & 0xfff);
+    }
+    mem_tlb_misses++;
+
     if (cr4 & CR4_PAE)
-        return mmutranslatereal_pae(addr, rw);
+        phys = mmutranslatereal_pae(addr, rw);
     else
-        return mmutranslatereal_normal(addr, rw);
+        phys = mmutranslatereal_normal(addr, rw);
+
+    if (!cpu_state.abrt) {
+        if (entry == NULL)
+            entry = mem_tlb_get(addr >> 12);
+        entry->xlat  = phys >> 12;
+        entry->flags = (entry->flags & (MEM_TLB_READ | MEM_TLB_WRITE)) | mmu_walk_flags;
+    }
+
+    return phys;
 }
 
 /* This is needed because the old recompiler calls this to check for page fault. */
@@ -583,9 +827,23 @@ mem_addr_translate(uint32_t addr, uint32_t chunk_start, uint32_t len)
     return chunk_start + (addr & mask);
 }
 
+/* Returns the TLB entry to hang a direct pointer for a page off. */
+static mem_tlb_entry_t *
+mem_tlb_get_view(uint32_t virt, uint32_t phys)
+{
+    mem_tlb_entry_t *entry = mem_tlb_get(virt >> 12);
+
+    if ((entry->flags & (MEM_TLB_READ | MEM_TLB_WRITE)) && (entry->phys != (phys >> 12)))
+        mem_tlb_drop_views(entry, MEM_TLB_READ | MEM_TLB_WRITE);
+    entry->phys = phys >> 12;
+
+    return entry;
+}
+
 void
 addreadlookup(uint32_t virt, uint32_t phys)
 {
+    mem_tlb_entry_t *entry;
 #if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
     uint32_t a;
 #endif
@@ -596,11 +854,7 @@ addreadlookup(uint32_t virt, uint32_t phys)
     if (readlookup2[virt >> 12] != (uintptr_t) LOOKUP_INV)
         return;
 
-    if (readlookup[readlnext] != (int) 0xffffffff) {
-        if ((readlookup[readlnext] == ((es + DI) >> 12)) || (readlookup[readlnext] == ((es + EDI) >> 12)))
-            uncached = 1;
-        readlookup2[readlookup[readlnext]] = LOOKUP_INV;
-    }
+    entry = mem_tlb_get_view(virt, phys);
 
 #if (defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64)
     readlookup2[virt >> 12] = (uintptr_t) &ram[(uintptr_t) (phys & ~0xFFF) - (uintptr_t) (virt & ~0xfff)];
@@ -613,8 +867,7 @@ addreadlookup(uint32_t virt, uint32_t phys)
         readlookup2[virt >> 12] = (uintptr_t) &ram[a];
 #endif
 
-    readlookup[readlnext++] = virt >> 12;
-    readlnext &= (cachesize - 1);
+    entry->flags |= MEM_TLB_READ;
 
     cycles -= 9;
 }
@@ -622,6 +875,7 @@ addreadlookup(uint32_t virt, uint32_t phys)
 void
 addwritelookup(uint32_t virt, uint32_t phys)
 {
+    mem_tlb_entry_t *entry;
 #if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
     uint32_t a;
 #endif
@@ -632,10 +886,7 @@ addwritelookup(uint32_t virt, uint32_t phys)
     if (page_lookup[virt >> 12])
         return;
 
-    if (writelookup[writelnext] != -1) {
-        page_lookup[writelookup[writelnext]]  = NULL;
-        writelookup2[writelookup[writelnext]] = LOOKUP_INV;
-    }
+    entry = mem_tlb_get_view(virt, phys);
 
 #ifdef USE_NEW_DYNAREC
 #    ifdef USE_DYNAREC
@@ -664,8 +915,7 @@ addwritelookup(uint32_t virt, uint32_t phys)
 #endif
     }
 
-    writelookup[writelnext++] = virt >> 12;
-    writelnext &= (cachesize - 1);
+    entry->flags |= MEM_TLB_WRITE;
 
     cycles -= 9;
 }
@@ -1819,6 +2069,102 @@ mem_write_phys(void *src, uint32_t addr, int transfer_size)
     }
 }
 
+/*
+ * Number of bytes from addr that can be copied straight out of the
+ * exec pointer of a mapping, up to the end of the granule or of the
+ * mapping's mask, whichever comes first, rounded down to whole units
+ * of transfer_size.
+ */
+static uint32_t
+mem_phys_block_span(mem_mapping_t *map, uint32_t addr, uint32_t size, int transfer_size)
+{
+    uint32_t offset = (addr - map->base) & map->mask;
+    uint32_t span   = MEM_GRANULARITY_SIZE - (addr & MEM_GRANULARITY_MASK);
+
+    /* Written this way because the mask can be 0xffffffff. */
+    if ((span - 1) > (map->mask - offset))
+        span = map->mask - offset + 1;
+    if (span > size)
+        span = size;
+
+    return span - (span % transfer_size);
+}
+
+/*
+ * Read a block of physical memory the way a bus master would, as
+ * transfer_size wide accesses. Each granule is looked up once and
+ * copied with memcpy() if it is directly accessible, otherwise the
+ * mapping's handlers are called for each access.
+ */
+void
+mem_read_phys_block(void *dest, uint32_t addr, uint32_t size, int transfer_size)
+{
+    uint8_t *p   = (uint8_t *) dest;
+    uint32_t n   = size - (size % transfer_size);
+    uint32_t pos = 0;
+    uint8_t  bytes[4];
+
+    mem_logical_addr = 0xffffffff;
+
+    while (pos < n) {
+        mem_mapping_t *map  = read_mapping_bus[(addr + pos) >> MEM_GRANULARITY_BITS];
+        uint32_t       span = 0;
+
+        if (cpu_use_exec && map && map->exec)
+            span = mem_phys_block_span(map, addr + pos, n - pos, transfer_size);
+
+        if (span) {
+            memcpy(&p[pos], &map->exec[(addr + pos - map->base) & map->mask], span);
+            pos += span;
+        } else {
+            /* Not directly accessible, or the access crosses a granule. */
+            mem_read_phys(&p[pos], addr + pos, transfer_size);
+            pos += transfer_size;
+        }
+    }
+
+    /* The trailing partial access, if there is one. */
+    if (n != size) {
+        mem_read_phys(bytes, addr + n, transfer_size);
+        memcpy(&p[n], bytes, size - n);
+    }
+}
+
+void
+mem_write_phys_block(const void *src, uint32_t addr, uint32_t size, int transfer_size)
+{
+    const uint8_t *p   = (const uint8_t *) src;
+    uint32_t       n   = size - (size % transfer_size);
+    uint32_t       pos = 0;
+    uint8_t        bytes[4];
+
+    mem_logical_addr = 0xffffffff;
+
+    while (pos < n) {
+        mem_mapping_t *map  = write_mapping_bus[(addr + pos) >> MEM_GRANULARITY_BITS];
+        uint32_t       span = 0;
+
+        if (cpu_use_exec && map && map->exec)
+            span = mem_phys_block_span(map, addr + pos, n - pos, transfer_size);
+
+        if (span) {
+            memcpy(&map->exec[(addr + pos - map->base) & map->mask], &p[pos], span);
+            pos += span;
+        } else {
+            /* Not directly accessible, or the access crosses a granule. */
+            mem_write_phys((void *) &p[pos], addr + pos, transfer_size);
+            pos += transfer_size;
+        }
+    }
+
+    /* The trailing partial access, if there is one, as read-modify-write. */
+    if (n != size) {
+        mem_read_phys(bytes, addr + n, transfer_size);
+        memcpy(bytes, &p[n], size - n);
+        mem_write_phys(bytes, addr + n, transfer_size);
+    }
+}
+
 uint8_t
 mem_read_ram(uint32_t addr, UNUSED(void *priv))
 {
@@ -2320,6 +2666,145 @@ mem_mapping_access_allowed(uint32_t flags, uint16_t access)
     return ret;
 }
 
+/* Address index of the enabled mappings, so that mem_mapping_recalc() only
+   has to look at the mappings overlapping the range it recalculates, rather
+   than the whole list. Each bucket lists the mappings overlapping its part of
+   the address space, in no particular order. Mappings spanning more than
+   MEM_MAP_INDEX_MAX_SPAN buckets, and mappings aliased by base_ignore, are
+   kept on the wide list which is looked at for every range instead. */
+#define MEM_MAP_INDEX_BITS     20
+#define MEM_MAP_INDEX_NO       (1 << (32 - MEM_MAP_INDEX_BITS))
+#define MEM_MAP_INDEX_MAX_SPAN 16
+
+#define MEM_MAP_NOT_INDEXED    0
+#define MEM_MAP_INDEXED        1
+#define MEM_MAP_INDEXED_WIDE   2
+
+typedef struct mem_map_node_t {
+    mem_mapping_t         *map;
+    struct mem_map_node_t *next;
+} mem_map_node_t;
+
+static mem_map_node_t  *map_index[MEM_MAP_INDEX_NO];
+static mem_map_node_t  *map_index_wide;
+static mem_mapping_t  **recalc_maps;
+static uint32_t         recalc_maps_size;
+static uint32_t         recalc_stamp;
+
+static void
+mem_map_index_link(mem_map_node_t **list, mem_mapping_t *map)
+{
+    mem_map_node_t *node = (mem_map_node_t *) malloc(sizeof(mem_map_node_t));
+
+    node->map  = map;
+    node->next = *list;
+    *list      = node;
+}
+
+static void
+mem_map_index_unlink(mem_map_node_t **list, const mem_mapping_t *map)
+{
+    mem_map_node_t *node;
+
+    while ((node = *list) != NULL) {
+        if (node->map == map) {
+            *list = node->next;
+            free(node);
+            return;
+        }
+        list = &node->next;
+    }
+}
+
+static void
+mem_map_index_free(mem_map_node_t **list)
+{
+    mem_map_node_t *node;
+
+    while ((node = *list) != NULL) {
+        *list = node->next;
+        free(node);
+    }
+}
+
+/* Move a mapping to where its current address, size and enable state put it
+   in the index. Must be called before any recalc after one of those changed. */
+static void
+mem_mapping_reindex(mem_mapping_t *map)
+{
+    uint8_t  indexed = MEM_MAP_NOT_INDEXED;
+    uint16_t first   = 0;
+    uint16_t last    = 0;
+
+    /* Only mappings on the list are indexed, as only those were ever walked. */
+    if (map->seq && map->enable && map->size) {
+        first = map->base >> MEM_MAP_INDEX_BITS;
+        last  = ((uint64_t) map->base + map->size - 1) >> MEM_MAP_INDEX_BITS;
+        if ((last >= MEM_MAP_INDEX_NO) || ((uint64_t) map->base + map->size > 0x100000000ULL))
+            last = MEM_MAP_INDEX_NO - 1;
+
+        if (map->base_ignore || ((last - first) >= MEM_MAP_INDEX_MAX_SPAN))
+            indexed = MEM_MAP_INDEXED_WIDE;
+        else
+            indexed = MEM_MAP_INDEXED;
+    }
+
+    if ((indexed == map->indexed) && ((indexed != MEM_MAP_INDEXED) ||
+        ((first == map->index_first) && (last == map->index_last))))
+        return;
+
+    if (map->indexed == MEM_MAP_INDEXED_WIDE)
+        mem_map_index_unlink(&map_index_wide, map);
+    else if (map->indexed == MEM_MAP_INDEXED) {
+        for (uint32_t c = map->index_first; c <= map->index_last; c++)
+            mem_map_index_unlink(&map_index[c], map);
+    }
+
+    if (indexed == MEM_MAP_INDEXED_WIDE)
+        mem_map_index_link(&map_index_wide, map);
+    else if (indexed == MEM_MAP_INDEXED) {
+        for (uint32_t c = first; c <= last; c++)
+            mem_map_index_link(&map_index[c], map);
+    }
+
+    map->indexed     = indexed;
+    map->index_first = first;
+    map->index_last  = last;
+}
+
+static void
+mem_map_index_reset(void)
+{
+    for (uint32_t c = 0; c < MEM_MAP_INDEX_NO; c++)
+        mem_map_index_free(&map_index[c]);
+    mem_map_index_free(&map_index_wide);
+
+    mapping_seq   = 0;
+    mapping_count = 0;
+}
+
+static uint32_t
+mem_map_index_gather(const mem_map_node_t *node, uint32_t nr)
+{
+    for (; node != NULL; node = node->next) {
+        if (node->map->stamp != recalc_stamp) {
+            node->map->stamp  = recalc_stamp;
+            recalc_maps[nr++] = node->map;
+        }
+    }
+
+    return nr;
+}
+
+static int
+mem_mapping_seq_compare(const void *a, const void *b)
+{
+    const mem_mapping_t *map_a = *(mem_mapping_t * const *) a;
+    const mem_mapping_t *map_b = *(mem_mapping_t * const *) b;
+
+    return (map_a->seq > map_b->seq) - (map_a->seq < map_b->seq);
+}
+
 void
 mem_mapping_recalc(uint64_t base, uint64_t size)
 {
@@ -2327,12 +2812,14 @@ mem_mapping_recalc(uint64_t base, uint64_t size)
     int            n;
     uint64_t       c;
     uint8_t        wp;
+    uint32_t       first;
+    uint32_t       last;
+    uint32_t       nr    = 0;
+    int            alias = 0;
 
     if (!size || (base_mapping == NULL))
         return;
 
-    map = base_mapping;
-
     /* Clear out old mappings. */
     for (c = base; c < base + size; c += MEM_GRANULARITY_SIZE) {
         _mem_exec[c >> MEM_GRANULARITY_BITS]         = NULL;
@@ -2342,8 +2829,28 @@ mem_mapping_recalc(uint64_t base, uint64_t size)
         read_mapping_bus[c >> MEM_GRANULARITY_BITS]  = NULL;
     }
 
-    /* Walk mapping list. */
-    while (map != NULL) {
+    /* Gather the mappings that may overlap the range. */
+    if (recalc_maps_size < mapping_count) {
+        recalc_maps_size = mapping_count + 64;
+        recalc_maps      = (mem_mapping_t **) realloc(recalc_maps, recalc_maps_size * sizeof(mem_mapping_t *));
+    }
+    recalc_stamp++;
+
+    first = base >> MEM_MAP_INDEX_BITS;
+    last  = (base + size - 1) >> MEM_MAP_INDEX_BITS;
+    if (last >= MEM_MAP_INDEX_NO)
+        last = MEM_MAP_INDEX_NO - 1;
+    for (uint32_t b = first; b <= last; b++)
+        nr = mem_map_index_gather(map_index[b], nr);
+    nr = mem_map_index_gather(map_index_wide, nr);
+
+    /* Later mappings in the list take precedence, so apply them in order. */
+    if (nr > 1)
+        qsort(recalc_maps, nr, sizeof(mem_mapping_t *), mem_mapping_seq_compare);
+
+    for (uint32_t m = 0; m < nr; m++) {
+        map = recalc_maps[m];
+
         /* In range? */
         if (map->enable && (uint64_t) map->base < ((uint64_t) base + (uint64_t) size) &&
             ((uint64_t) map->base + (uint64_t) map->size) > (uint64_t) base) {
@@ -2357,6 +2864,9 @@ mem_mapping_recalc(uint64_t base, uint64_t size)
             if (start < map->base)
                 start = map->base;
 
+            if (map->base_ignore)
+                alias = 1;
+
             for (i_c = i_s; i_c <= i_e; i_c += i_a) {
                 for (c = (start + i_c); c < (end + i_c); c += MEM_GRANULARITY_SIZE) {
                     /* CPU */
@@ -2390,10 +2900,13 @@ mem_mapping_recalc(uint64_t base, uint64_t size)
                 }
             }
         }
-        map = map->next;
     }
 
-    flushmmucache_nopc();
+    /* Aliased mappings also change granules outside of the range. */
+    if (alias)
+        flushmmucache_nopc();
+    else
+        flushmmucache_phys(base, size);
 
 #ifdef ENABLE_MEM_LOG
     pclog("\nMemory map:\n");
@@ -2492,9 +3005,10 @@ mem_mapping_set(mem_mapping_t *map,
     map->exec    = exec;
     map->flags   = fl;
     map->priv    = priv;
-    map->next    = NULL;
     mem_log("mem_mapping_add(): Linked list structure: %08X -> %08X -> %08X\n", map->prev, map, map->next);
 
+    mem_mapping_reindex(map);
+
     /* If the mapping is disabled, there is no need to recalc anything. */
     if (size != 0x00000000)
         mem_mapping_recalc(map->base, map->size);
@@ -2540,8 +3054,13 @@ mem_mapping_add(mem_mapping_t *map,
         map->prev          = last_mapping;
         last_mapping->next = map;
     }
+    map->next    = NULL;
     last_mapping = map;
 
+    map->seq     = ++mapping_seq;
+    map->indexed = MEM_MAP_NOT_INDEXED;
+    mapping_count++;
+
     mem_mapping_set(map, base, size, read_b, read_w, read_l,
                     write_b, write_w, write_l, exec, fl, priv);
 }
@@ -2549,6 +3068,7 @@ mem_mapping_add(mem_mapping_t *map,
 void
 mem_mapping_do_recalc(mem_mapping_t *map)
 {
+    mem_mapping_reindex(map);
     mem_mapping_recalc(map->base, map->size);
 }
 
@@ -2589,12 +3109,14 @@ mem_mapping_set_addr(mem_mapping_t *map, uint32_t base, uint32_t size)
 {
     /* Remove old mapping. */
     map->enable = 0;
+    mem_mapping_reindex(map);
     mem_mapping_recalc(map->base, map->size);
 
     /* Set new mapping. */
     map->enable = 1;
     map->base   = base;
     map->size   = size;
+    mem_mapping_reindex(map);
 
     mem_mapping_recalc(map->base, map->size);
 }
@@ -2604,11 +3126,13 @@ mem_mapping_set_base_ignore(mem_mapping_t *map, uint32_t base_ignore)
 {
     /* Remove old mapping. */
     map->enable      = 0;
+    mem_mapping_reindex(map);
     mem_mapping_recalc(map->base, map->size);
 
     /* Set new mapping. */
     map->enable      = 1;
     map->base_ignore = base_ignore;
+    mem_mapping_reindex(map);
 
     mem_mapping_recalc(map->base, map->size);
 }
@@ -2639,6 +3163,7 @@ void
 mem_mapping_disable(mem_mapping_t *map)
 {
     map->enable = 0;
+    mem_mapping_reindex(map);
 
     mem_mapping_recalc(map->base, map->size);
 }
@@ -2647,6 +3172,7 @@ void
 mem_mapping_enable(mem_mapping_t *map)
 {
     map->enable = 1;
+    mem_mapping_reindex(map);
 
     mem_mapping_recalc(map->base, map->size);
 }
@@ -2717,20 +3243,36 @@ mem_a20_init(void)
     }
 }
 
-/* Close all the memory mappings. */
-void
-mem_close(void)
+/* Take all the mappings off the list and out of the index, so that none of
+   them is taken as already listed or indexed when it is added again. */
+static void
+mem_mapping_list_clear(void)
 {
     mem_mapping_t *map = base_mapping;
     mem_mapping_t *next;
 
     while (map != NULL) {
-        next      = map->next;
-        map->prev = map->next = NULL;
-        map                   = next;
+        next         = map->next;
+        map->prev    = map->next = NULL;
+        map->seq     = 0;
+        map->indexed = MEM_MAP_NOT_INDEXED;
+        map          = next;
     }
 
-    base_mapping = last_mapping = 0;
+    base_mapping = last_mapping = NULL;
+    mem_map_index_reset();
+}
+
+/* Close all the memory mappings. */
+void
+mem_close(void)
+{
+    mem_log("Software TLB: %" PRIu64 " hits, %" PRIu64 " misses (%i%% hit rate), %" PRIu64 " evictions, %" PRIu64 " flushes\n",
+            mem_tlb_hits, mem_tlb_misses,
+            (mem_tlb_hits + mem_tlb_misses) ? (int) ((mem_tlb_hits * 100) / (mem_tlb_hits + mem_tlb_misses)) : 0,
+            mem_tlb_evictions, mem_tlb_flushes);
+
+    mem_mapping_list_clear();
 }
 
 static void
@@ -2760,6 +3302,125 @@ mem_zero(void)
     memset(ram, 0x00, ram_size + 16);
 }
 
+/* Report how much host memory the guest RAM and its metadata occupy. */
+void
+mem_get_usage(mem_usage_t *usage)
+{
+    memset(usage, 0x00, sizeof(mem_usage_t));
+
+    if (ram != NULL) {
+        usage->ram_size     = ram_size;
+        usage->ram_resident = plat_mresident(ram, ram_size);
+    }
+#if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
+    if (ram2_size && (ram2 != NULL)) {
+        usage->ram_size += ram2_size;
+        usage->ram_resident += plat_mresident(ram2, ram2_size);
+    }
+#endif
+
+    if (pages != NULL) {
+        usage->meta_size     = pages_sz * sizeof(page_t);
+        usage->meta_resident = plat_mresident(pages, usage->meta_size);
+    }
+#ifdef USE_NEW_DYNAREC
+    if (byte_dirty_mask != NULL) {
+        usage->meta_size += 2 * byte_mask_size;
+        usage->meta_resident += plat_mresident(byte_dirty_mask, byte_mask_size);
+        usage->meta_resident += plat_mresident(byte_code_present_mask, byte_mask_size);
+    }
+#endif
+}
+
+typedef struct mem_page_hash_t {
+    uint64_t hash;
+    uint32_t page;
+} mem_page_hash_t;
+
+static uint8_t *
+mem_dedup_page(uint32_t page)
+{
+#if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
+    if ((mem_size > 1048576) && (page >= (1 << 18)))
+        return &ram2[(page << 12) - (1 << 30)];
+#endif
+
+    return &ram[page << 12];
+}
+
+static int
+mem_dedup_compare(const void *a, const void *b)
+{
+    const mem_page_hash_t *pa = (const mem_page_hash_t *) a;
+    const mem_page_hash_t *pb = (const mem_page_hash_t *) b;
+
+    if (pa->hash != pb->hash)
+        return (pa->hash < pb->hash) ? -1 : 1;
+
+    return (pa->page < pb->page) ? -1 : (pa->page > pb->page);
+}
+
+/*
+ * Hash every page of guest RAM to find out how many pages have the
+ * same contents, and so could be shared with KSM or the like. This
+ * reads guest RAM while the CPU may be writing to it, so the figures
+ * are a snapshot and only approximate.
+ */
+void
+mem_dedup_scan(mem_dedup_t *dedup)
+{
+    mem_page_hash_t *hashes;
+    uint32_t         nr_pages = mem_size >> 2;
+    uint32_t         nr       = 0;
+    uint32_t         first    = 0;
+
+    memset(dedup, 0x00, sizeof(mem_dedup_t));
+
+    if ((ram == NULL) || !nr_pages)
+        return;
+
+    hashes = (mem_page_hash_t *) malloc(nr_pages * sizeof(mem_page_hash_t));
+    if (hashes == NULL)
+        return;
+
+    for (uint32_t c = 0; c < nr_pages; c++) {
+        const uint64_t *p    = (const uint64_t *) mem_dedup_page(c);
+        uint64_t        hash = 0xcbf29ce484222325ULL;
+        uint64_t        bits = 0;
+
+        /* FNV-1a, a quadword at a time. */
+        for (int d = 0; d < (4096 / 8); d++) {
+            bits |= p[d];
+            hash ^= p[d];
+            hash *= 0x100000001b3ULL;
+        }
+
+        if (bits == 0)
+            dedup->zero_pages++;
+        else {
+            hashes[nr].hash   = hash;
+            hashes[nr++].page = c;
+        }
+    }
+
+    qsort(hashes, nr, sizeof(mem_page_hash_t), mem_dedup_compare);
+
+    /* Equal hashes are checked byte by byte against the first page of the run. */
+    for (uint32_t c = 0; c < nr; c++) {
+        if ((c > 0) && (hashes[c].hash == hashes[first].hash) &&
+            !memcmp(mem_dedup_page(hashes[c].page), mem_dedup_page(hashes[first].page), 4096))
+            dedup->dup_pages++;
+        else {
+            dedup->unique_pages++;
+            first = c;
+        }
+    }
+
+    dedup->pages = nr_pages;
+
+    free(hashes);
+}
+
 /* Reset the memory state. */
 void
 mem_reset(void)
@@ -2770,19 +3431,19 @@ mem_reset(void)
 
 #ifdef USE_NEW_DYNAREC
     if (byte_dirty_mask) {
-        free(byte_dirty_mask);
+        plat_munmap(byte_dirty_mask, byte_mask_size);
         byte_dirty_mask = NULL;
     }
 
     if (byte_code_present_mask) {
-        free(byte_code_present_mask);
+        plat_munmap(byte_code_present_mask, byte_mask_size);
         byte_code_present_mask = NULL;
     }
 #endif
 
     /* Free the old pages array, if necessary. */
     if (pages) {
-        free(pages);
+        plat_munmap(pages, pages_sz * sizeof(page_t));
         pages = NULL;
     }
 
@@ -2812,7 +3473,9 @@ mem_reset(void)
             fatal("Failed to allocate primary RAM block. Make sure you have enough RAM available.\n");
             return;
         }
-        memset(ram, 0x00, ram_size);
+        plat_mmap_hugepages(ram, ram_size);
+        if (mem_ksm)
+            plat_mmap_mergeable(ram, ram_size);
         ram2_size = m - (1 << 30);
         /* Allocate 16 extra bytes of RAM to mitigate some dynarec recompiler memory access quirks. */
         ram2      = (uint8_t *) plat_mmap(ram2_size + 16, 0); /* allocate and clear the RAM block above 1 GB */
@@ -2823,7 +3486,9 @@ mem_reset(void)
                 fatal("Failed to allocate secondary RAM block. Make sure you have enough RAM available.\n");
             return;
         }
-        memset(ram2, 0x00, ram2_size + 16);
+        plat_mmap_hugepages(ram2, ram2_size + 16);
+        if (mem_ksm)
+            plat_mmap_mergeable(ram2, ram2_size + 16);
     } else
 #endif
     {
@@ -2834,7 +3499,9 @@ mem_reset(void)
             fatal("Failed to allocate RAM block. Make sure you have enough RAM available.\n");
             return;
         }
-        memset(ram, 0x00, ram_size + 16);
+        plat_mmap_hugepages(ram, ram_size + 16);
+        if (mem_ksm)
+            plat_mmap_mergeable(ram, ram_size + 16);
 #if (!(defined __amd64__ || defined _M_X64 || defined __aarch64__ || defined _M_ARM64))
         if (mem_size > 1048576)
             ram2 = &(ram[1 << 30]);
@@ -2866,20 +3533,28 @@ mem_reset(void)
 
     /*
      * Allocate and initialize the (new) page table.
+     *
+     * This and the byte masks below come straight from the host
+     * as zeroed, demand-paged memory, so the byte masks of pages
+     * the guest never runs code from never take up host memory.
      */
     pages_sz = m;
-    pages    = (page_t *) malloc(m * sizeof(page_t));
+    pages    = (page_t *) plat_mmap(m * sizeof(page_t), 0);
+    if (pages == NULL) {
+        fatal("Failed to allocate the page table.\n");
+        return;
+    }
 
     memset(page_lookup, 0x00, (1 << 20) * sizeof(page_t *));
 
-    memset(pages, 0x00, pages_sz * sizeof(page_t));
-
 #ifdef USE_NEW_DYNAREC
-    byte_dirty_mask = malloc((mem_size * 1024) / 8);
-    memset(byte_dirty_mask, 0, (mem_size * 1024) / 8);
-
-    byte_code_present_mask = malloc((mem_size * 1024) / 8);
-    memset(byte_code_present_mask, 0, (mem_size * 1024) / 8);
+    byte_mask_size         = (mem_size * 1024) / 8;
+    byte_dirty_mask        = (uint64_t *) plat_mmap(byte_mask_size, 0);
+    byte_code_present_mask = (uint64_t *) plat_mmap(byte_mask_size, 0);
+    if ((byte_dirty_mask == NULL) || (byte_code_present_mask == NULL)) {
+        fatal("Failed to allocate the dirty masks.\n");
+        return;
+    }
 #endif
 
     for (uint32_t c = 0; c < pages_sz; c++) {
@@ -2918,7 +3593,7 @@ mem_reset(void)
     memset(write_mapping_bus, 0x00, sizeof(write_mapping_bus));
     memset(read_mapping_bus, 0x00, sizeof(read_mapping_bus));
 
-    base_mapping = last_mapping = NULL;
+    mem_mapping_list_clear();
 
     /* Set the entire memory space as external. */
     memset(_mem_state, 0x00, sizeof(_mem_state));
@@ -271,6 +271,38 @@ mmutranslate_noabrt_2386(uint32_t addr, int rw)
     return (uint64_t) ((temp & ~0xfff) + (addr & 0xfff));
 }
 
+/* Code fetch cache. Every access made by the 286/386 interpreter goes through
+   a full page table walk, which makes instruction fetch very expensive. Once a
+   fetch from a RAM page has succeeded, the page is remembered - as it would be
+   by the TLB of a real 386 - and later fetches from it at the same CPL read RAM
+   directly, until the next MMU cache flush (CR0/CR3 write, INVLPG, memory
+   mapping change). ROM and device memory, debug register breakpoints and pending
+   paging changes always take the normal path.
+
+   This only caches the one page being fetched from, not decoded instructions:
+   the opcode handlers fetch and decode their own ModR/M, SIB, displacement and
+   immediates, so there is nothing decoded to keep. As the bytes are read from
+   RAM on every fetch, self-modifying code needs no invalidation. */
+void
+pccache_fill_2386(uint32_t addr, uint32_t phys)
+{
+#ifndef USE_GDBSTUB
+    const mem_mapping_t *map;
+
+    if (cpu_flush_pending || (dr[7] & 0x000000ff))
+        return;
+
+    phys &= rammask;
+    map = read_mapping[phys >> MEM_GRANULARITY_BITS];
+
+    if (!map || (map->read_b != mem_read_ram) || !_mem_exec[phys >> MEM_GRANULARITY_BITS])
+        return;
+
+    pccache_2386  = (addr & ~0xfff) | CPL;
+    pccache2_2386 = &_mem_exec[phys >> MEM_GRANULARITY_BITS][phys & MEM_GRANULARITY_PAGE];
+#endif
+}
+
 uint8_t
 readmembl_2386(uint32_t addr)
 {
@@ -662,21 +662,56 @@ bios_load_linear_combined2_ex(const char *fn1, const char *fn2, const char *fn3,
     return ret;
 }
 
+/*
+ * Map a ROM image straight from its file, so that all instances of
+ * the emulator using the same image share the host memory it takes
+ * up. The mapping is copy-on-write, so devices that patch or flash
+ * their ROM still work. This is only possible if the image fills
+ * the entire buffer, starting at its beginning.
+ */
+static uint8_t *
+rom_map_linear(const char *fn, uint32_t addr, int sz, int off)
+{
+    uint8_t *ret = NULL;
+    FILE    *fp;
+
+    /* Same base offset calculation as rom_load_linear(). */
+    if ((addr < 0x40000) && (addr & 0x03ffff))
+        return NULL;
+
+    if ((sz <= 0) || (off < 0))
+        return NULL;
+
+    fp = rom_fopen(fn, "rb");
+    if (fp == NULL)
+        return NULL;
+
+    if ((fseek(fp, 0, SEEK_END) == 0) && (ftell(fp) >= ((long) off + sz)))
+        ret = (uint8_t *) plat_mmap_file(fp, off, sz);
+
+    (void) fclose(fp);
+
+    return ret;
+}
+
 int
 rom_init(rom_t *rom, const char *fn, uint32_t addr, int sz, int mask, int off, uint32_t flags)
 {
     rom_log("rom_init(%08X, %s, %08X, %08X, %08X, %08X, %08X)\n", rom, fn, addr, sz, mask, off, flags);
 
-    /* Allocate a buffer for the image. */
-    rom->rom = malloc(sz);
-    memset(rom->rom, 0xff, sz);
-
-    /* Load the image file into the buffer. */
-    if (!rom_load_linear(fn, addr, sz, off, rom->rom)) {
-        /* Nope.. clean up. */
-        free(rom->rom);
-        rom->rom = NULL;
-        return (-1);
+    rom->rom = rom_map_linear(fn, addr, sz, off);
+    if (rom->rom == NULL) {
+        /* Allocate a buffer for the image. */
+        rom->rom = malloc(sz);
+        memset(rom->rom, 0xff, sz);
+
+        /* Load the image file into the buffer. */
+        if (!rom_load_linear(fn, addr, sz, off, rom->rom)) {
+            /* Nope.. clean up. */
+            free(rom->rom);
+            rom->rom = NULL;
+            return (-1);
+        }
     }
 
     rom->sz   = sz;
@@ -270,25 +270,45 @@ network_init(void)
 }
 
 void
-network_queue_init(netqueue_t *queue)
-{
-    queue->head = queue->tail = 0;
-    for (int i = 0; i < NET_QUEUE_LEN; i++) {
+network_queue_init(netqueue_t *queue, uint32_t size)
+{
+    queue->packets = calloc(size, sizeof(netpkt_t));
+    queue->size    = size;
+    queue->mask    = size - 1;
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    for (uint32_t i = 0; i < size; i++) {
         queue->packets[i].data = calloc(1, NET_MAX_FRAME);
         queue->packets[i].len  = 0;
     }
 }
 
-static bool
-network_queue_full(netqueue_t *queue)
+/* Number of packets queued, as seen by the consumer. */
+static inline uint32_t
+network_queue_count(netqueue_t *queue)
+{
+    return atomic_load_explicit(&queue->head, memory_order_acquire) - atomic_load_explicit(&queue->tail, memory_order_relaxed);
+}
+
+/* Number of free slots, as seen by the producer. */
+static inline uint32_t
+network_queue_space(netqueue_t *queue)
 {
-    return ((queue->head + 1) & NET_QUEUE_LEN_MASK) == queue->tail;
+    return queue->size - (atomic_load_explicit(&queue->head, memory_order_relaxed) - atomic_load_explicit(&queue->tail, memory_order_acquire));
 }
 
-static bool
-network_queue_empty(netqueue_t *queue)
+/* Packet n places behind the tail, only valid for n < network_queue_count(). */
+static inline netpkt_t *
+network_queue_peek(netqueue_t *queue, uint32_t n)
+{
+    return &queue->packets[(atomic_load_explicit(&queue->tail, memory_order_relaxed) + n) & queue->mask];
+}
+
+/* Hand the n oldest packets back to the producer. */
+static inline void
+network_queue_consume(netqueue_t *queue, uint32_t n)
 {
-    return (queue->head == queue->tail);
+    atomic_store_explicit(&queue->tail, atomic_load_explicit(&queue->tail, memory_order_relaxed) + n, memory_order_release);
 }
 
 static inline void
@@ -302,21 +322,26 @@ network_swap_packet(netpkt_t *pkt1, netpkt_t *pkt2)
 int
 network_queue_put(netqueue_t *queue, uint8_t *data, int len)
 {
-    if (len == 0 || len > NET_MAX_FRAME || network_queue_full(queue)) {
+    uint32_t head;
+
+    if (len == 0 || len > NET_MAX_FRAME || !network_queue_space(queue)) {
         return 0;
     }
 
-    netpkt_t *pkt = &queue->packets[queue->head];
+    head          = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    netpkt_t *pkt = &queue->packets[head & queue->mask];
     memcpy(pkt->data, data, len);
-    pkt->len    = len;
-    queue->head = (queue->head + 1) & NET_QUEUE_LEN_MASK;
+    pkt->len = len;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
     return 1;
 }
 
 int
 network_queue_put_swap(netqueue_t *queue, netpkt_t *src_pkt)
 {
-    if (src_pkt->len == 0 || src_pkt->len > NET_MAX_FRAME || network_queue_full(queue)) {
+    uint32_t head;
+
+    if (src_pkt->len == 0 || src_pkt->len > NET_MAX_FRAME || !network_queue_space(queue)) {
 #ifdef DEBUG
         if (src_pkt->len == 0) {
             network_log("Discarded zero length packet.\n");
@@ -329,53 +354,93 @@ network_queue_put_swap(netqueue_t *queue, netpkt_t *src_pkt)
         return 0;
     }
 
-    netpkt_t *dst_pkt = &queue->packets[queue->head];
+    head              = atomic_load_explicit(&queue->head, memory_order_relaxed);
+    netpkt_t *dst_pkt = &queue->packets[head & queue->mask];
     network_swap_packet(src_pkt, dst_pkt);
 
-    queue->head = (queue->head + 1) & NET_QUEUE_LEN_MASK;
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
     return 1;
 }
 
+/* Dequeue up to vec_size packets in one go, swapping them into pkt_vec. */
 static int
-network_queue_get_swap(netqueue_t *queue, netpkt_t *dst_pkt)
+network_queue_get_swapv(netqueue_t *queue, netpkt_t *pkt_vec, int vec_size)
 {
-    if (network_queue_empty(queue))
-        return 0;
+    uint32_t count = network_queue_count(queue);
 
-    netpkt_t *src_pkt = &queue->packets[queue->tail];
-    network_swap_packet(src_pkt, dst_pkt);
-    queue->tail = (queue->tail + 1) & NET_QUEUE_LEN_MASK;
-    return 1;
+    if (count > (uint32_t) vec_size)
+        count = vec_size;
+
+    for (uint32_t i = 0; i < count; i++) {
+        network_swap_packet(network_queue_peek(queue, i), &pkt_vec[i]);
+        network_dump_packet(&pkt_vec[i]);
+    }
+    network_queue_consume(queue, count);
+
+    return count;
 }
 
-static int
+/* Move as many packets as fit from one queue to another, returning the number
+   of bytes moved. */
+static uint32_t
 network_queue_move(netqueue_t *dst_q, netqueue_t *src_q)
 {
-    if (network_queue_empty(src_q))
-        return 0;
+    uint32_t count = network_queue_count(src_q);
+    uint32_t space = network_queue_space(dst_q);
+    uint32_t head;
+    uint32_t bytes = 0;
 
-    if (network_queue_full(dst_q)) {
+    if (count > space)
+        count = space;
+    if (!count)
         return 0;
-    }
 
-    netpkt_t *src_pkt = &src_q->packets[src_q->tail];
-    netpkt_t *dst_pkt = &dst_q->packets[dst_q->head];
+    head = atomic_load_explicit(&dst_q->head, memory_order_relaxed);
+    for (uint32_t i = 0; i < count; i++) {
+        netpkt_t *dst_pkt = &dst_q->packets[(head + i) & dst_q->mask];
 
-    network_swap_packet(src_pkt, dst_pkt);
-    dst_q->head = (dst_q->head + 1) & NET_QUEUE_LEN_MASK;
-    src_q->tail = (src_q->tail + 1) & NET_QUEUE_LEN_MASK;
+        network_swap_packet(network_queue_peek(src_q, i), dst_pkt);
+        bytes += dst_pkt->len;
+    }
+    atomic_store_explicit(&dst_q->head, head + count, memory_order_release);
+    network_queue_consume(src_q, count);
 
-    return dst_pkt->len;
+    return bytes;
 }
 
 void
 network_queue_clear(netqueue_t *queue)
 {
-    for (int i = 0; i < NET_QUEUE_LEN; i++) {
+    for (uint32_t i = 0; i < queue->size; i++)
         free(queue->packets[i].data);
-        queue->packets[i].len = 0;
+    free(queue->packets);
+    queue->packets = NULL;
+    queue->size    = 0;
+    atomic_store(&queue->tail, 0);
+    atomic_store(&queue->head, 0);
+}
+
+/* Hand the card every packet waiting in a receive queue, stopping early if it
+   can not take any more. The packets are passed straight out of the queue, so
+   a packet the card refuses stays at the front for the next attempt. */
+static uint32_t
+network_rx_queue_deliver(netcard_t *card, netqueue_t *queue)
+{
+    uint32_t count    = network_queue_count(queue);
+    uint32_t rx_bytes = 0;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        netpkt_t *pkt = network_queue_peek(queue, i);
+
+        network_dump_packet(pkt);
+        if (!card->rx(card->card_drv, pkt->data, pkt->len))
+            break;
+        rx_bytes += pkt->len;
     }
-    queue->tail = queue->head = 0;
+    network_queue_consume(queue, i);
+
+    return rx_bytes;
 }
 
 static void
@@ -390,36 +455,15 @@ network_rx_queue(void *priv)
         card->link_state = new_link_state;
     }
 
-    uint32_t rx_bytes = 0;
-    for (int i = 0; i < NET_QUEUE_LEN; i++) {
-        if (card->queued_pkt.len == 0) {
-            thread_wait_mutex(card->rx_mutex);
-            int res = network_queue_get_swap(&card->queues[NET_QUEUE_RX], &card->queued_pkt);
-            thread_release_mutex(card->rx_mutex);
-            if (!res)
-                break;
-        }
-
-        network_dump_packet(&card->queued_pkt);
-        int res = card->rx(card->card_drv, card->queued_pkt.data, card->queued_pkt.len);
-        if (!res)
-            break;
-        rx_bytes += card->queued_pkt.len;
-        card->queued_pkt.len = 0;
-    }
+    /* Reception, the whole burst at once. */
+    uint32_t rx_bytes = network_rx_queue_deliver(card, &card->queues[NET_QUEUE_RX_VM]);
+    rx_bytes += network_rx_queue_deliver(card, &card->queues[NET_QUEUE_RX]);
 
     /* Transmission. */
-    uint32_t tx_bytes = 0;
-    thread_wait_mutex(card->tx_mutex);
-    for (int i = 0; i < NET_QUEUE_LEN; i++) {
-        uint32_t bytes = network_queue_move(&card->queues[NET_QUEUE_TX_HOST], &card->queues[NET_QUEUE_TX_VM]);
-        if (!bytes)
-            break;
-        tx_bytes += bytes;
-    }
-    thread_release_mutex(card->tx_mutex);
-    if (tx_bytes) {
-        /* Notify host that a packet is available in the TX queue */
+    uint32_t tx_bytes = network_queue_move(&card->queues[NET_QUEUE_TX_HOST], &card->queues[NET_QUEUE_TX_VM]);
+    if (tx_bytes || network_queue_count(&card->queues[NET_QUEUE_TX_HOST])) {
+        /* Notify host that a packet is available in the TX queue, also if
+           it has only left some behind from an earlier batch */
         card->host_drv.notify_in(card->host_drv.priv);
     }
 
@@ -452,20 +496,20 @@ network_attach(void *card_drv, uint8_t *mac, NETRXCB rx, NETSETLINKSTATE set_lin
 {
     netcard_t *card       = calloc(1, sizeof(netcard_t));
     int net_type          = net_cards_conf[net_card_current].net_type;
-    card->queued_pkt.data = calloc(1, NET_MAX_FRAME);
+    uint32_t   queue_len  = net_cards_conf[net_card_current].queue_len;
     card->card_drv        = card_drv;
     card->rx              = rx;
     card->set_link_state  = set_link_state;
-    card->tx_mutex        = thread_create_mutex();
-    card->rx_mutex        = thread_create_mutex();
     card->card_num        = net_card_current;
     card->byte_period     = NET_PERIOD_10M;
 
     char net_drv_error[NET_DRV_ERRBUF_SIZE];
     wchar_t tempmsg[NET_DRV_ERRBUF_SIZE * 2];
 
+    if (!queue_len)
+        queue_len = NET_QUEUE_LEN;
     for (int i = 0; i < NET_QUEUE_COUNT; i++) {
-        network_queue_init(&card->queues[i]);
+        network_queue_init(&card->queues[i], queue_len);
     }
 
     if ((!strcmp(network_card_get_internal_name(net_cards_conf[net_card_current].device_num), "modem") ||
@@ -517,13 +561,10 @@ network_attach(void *card_drv, uint8_t *mac, NETRXCB rx, NETSETLINKSTATE set_lin
         // If null fails, something is very wrong
         // Clean up and fatal
         if(!card->host_drv.priv) {
-            thread_close_mutex(card->tx_mutex);
-            thread_close_mutex(card->rx_mutex);
             for (int i = 0; i < NET_QUEUE_COUNT; i++) {
                 network_queue_clear(&card->queues[i]);
             }
 
-            free(card->queued_pkt.data);
             free(card);
             // Placeholder - insert the error message
             fatal("Error initializing the network device: Null driver initialization failed\n");
@@ -544,13 +585,10 @@ netcard_close(netcard_t *card)
     timer_stop(&card->timer);
     card->host_drv.close(card->host_drv.priv);
 
-    thread_close_mutex(card->tx_mutex);
-    thread_close_mutex(card->rx_mutex);
     for (int i = 0; i < NET_QUEUE_COUNT; i++) {
         network_queue_clear(&card->queues[i]);
     }
 
-    free(card->queued_pkt.data);
     free(card);
 }
 
@@ -595,6 +633,19 @@ network_reset(void)
     }
 }
 
+/*
+ * Packet queues.
+ *
+ * Every queue has a single producer and a single consumer, so none of these
+ * take a lock:
+ *
+ * NET_QUEUE_TX_VM    card (emulation thread) -> network_rx_queue() (same)
+ * NET_QUEUE_TX_HOST  network_rx_queue()      -> provider thread
+ * NET_QUEUE_RX       provider thread         -> network_rx_queue()
+ * NET_QUEUE_RX_VM    card loopback           -> network_rx_queue()
+ * NET_QUEUE_RX_ON_TX provider thread         -> provider thread (SLiRP)
+ */
+
 /* Queue a packet for transmission to one of the network providers. */
 void
 network_tx(netcard_t *card, uint8_t *bufp, int len)
@@ -605,93 +656,47 @@ network_tx(netcard_t *card, uint8_t *bufp, int len)
 int
 network_tx_pop(netcard_t *card, netpkt_t *out_pkt)
 {
-    int ret = 0;
-
-    thread_wait_mutex(card->tx_mutex);
-    ret = network_queue_get_swap(&card->queues[NET_QUEUE_TX_HOST], out_pkt);
-    thread_release_mutex(card->tx_mutex);
-
-    return ret;
+    return network_queue_get_swapv(&card->queues[NET_QUEUE_TX_HOST], out_pkt, 1);
 }
 
 int
 network_tx_popv(netcard_t *card, netpkt_t *pkt_vec, int vec_size)
 {
-    int pkt_count = 0;
-
-    netqueue_t *queue = &card->queues[NET_QUEUE_TX_HOST];
-    thread_wait_mutex(card->tx_mutex);
-    for (int i = 0; i < vec_size; i++) {
-        if (!network_queue_get_swap(queue, pkt_vec))
-            break;
-        network_dump_packet(pkt_vec);
-        pkt_count++;
-        pkt_vec++;
-    }
-    thread_release_mutex(card->tx_mutex);
-
-    return pkt_count;
+    return network_queue_get_swapv(&card->queues[NET_QUEUE_TX_HOST], pkt_vec, vec_size);
 }
 
+/* Loop a packet back to the card itself, only to be called from the
+   emulation thread. */
 int
 network_rx_put(netcard_t *card, uint8_t *bufp, int len)
 {
-    int ret = 0;
-
-    thread_wait_mutex(card->rx_mutex);
-    ret = network_queue_put(&card->queues[NET_QUEUE_RX], bufp, len);
-    thread_release_mutex(card->rx_mutex);
-
-    return ret;
+    return network_queue_put(&card->queues[NET_QUEUE_RX_VM], bufp, len);
 }
 
 int
 network_rx_on_tx_popv(netcard_t *card, netpkt_t *pkt_vec, int vec_size)
 {
-    int pkt_count = 0;
-
-    netqueue_t *queue = &card->queues[NET_QUEUE_RX_ON_TX];
-    for (int i = 0; i < vec_size; i++) {
-        if (!network_queue_get_swap(queue, pkt_vec))
-            break;
-        network_dump_packet(pkt_vec);
-        pkt_count++;
-        pkt_vec++;
-    }
-
-    return pkt_count;
+    return network_queue_get_swapv(&card->queues[NET_QUEUE_RX_ON_TX], pkt_vec, vec_size);
 }
 
 int
 network_rx_on_tx_put(netcard_t *card, uint8_t *bufp, int len)
 {
-    int ret = 0;
-
-    ret = network_queue_put(&card->queues[NET_QUEUE_RX_ON_TX], bufp, len);
-
-    return ret;
+    return network_queue_put(&card->queues[NET_QUEUE_RX_ON_TX], bufp, len);
 }
 
 int
 network_rx_on_tx_put_pkt(netcard_t *card, netpkt_t *pkt)
 {
-    int ret = 0;
-
-    ret = network_queue_put_swap(&card->queues[NET_QUEUE_RX_ON_TX], pkt);
-
-    return ret;
+    return network_queue_put_swap(&card->queues[NET_QUEUE_RX_ON_TX], pkt);
 }
 
+/* Queue a received packet for the card, only to be called from the
+   provider thread. */
 int
 network_rx_put_pkt(netcard_t *card, netpkt_t *pkt)
 {
-    int ret = 0;
-
-    thread_wait_mutex(card->rx_mutex);
-    ret = network_queue_put_swap(&card->queues[NET_QUEUE_RX], pkt);
-    thread_release_mutex(card->rx_mutex);
-
-    return ret;
+    return network_queue_put_swap(&card->queues[NET_QUEUE_RX], pkt);
 }
 
 void
@@ -66,6 +66,7 @@ extern "C" {
 #    include <windows.h>
 #endif
 
+#include <chrono>
 #include <thread>
 #include <iostream>
 #include <memory>
@@ -429,40 +430,41 @@ static HHOOK llhook  = NULL;
 void
 main_thread_fn()
 {
-    int      frames;
+    using slice_clock = std::chrono::steady_clock;
+    int                     frames;
+    slice_clock::time_point deadline;
 
     QThread::currentThread()->setPriority(QThread::HighestPriority);
     plat_set_thread_name(nullptr, "main_thread_fn");
     framecountx = 0;
     // title_update = 1;
-    uint64_t old_time = elapsed_timer.elapsed();
-    int drawits = frames = 0;
+    frames        = 0;
+    deadline      = slice_clock::now();
     is_cpu_thread = 1;
     while (!is_quit && cpu_thread_run) {
-        /* See if it is time to run a frame of code. */
-        const uint64_t new_time = elapsed_timer.elapsed();
+        /* See if it is time to run a slice of code. */
+        const slice_clock::time_point now = slice_clock::now();
 #ifdef USE_GDBSTUB
-        if (gdbstub_next_asap && (drawits <= 0))
-            drawits = 10;
-        else
+        if (gdbstub_next_asap && (deadline > now))
+            deadline = now;
 #endif
-            drawits += static_cast<int>(new_time - old_time);
-        old_time = new_time;
-        if (drawits > 0 && !dopause) {
-            /* Yes, so do one frame now. */
-            drawits -= 10;
-            if (drawits > 50)
-                drawits = 0;
+        if (!dopause && !turbo_mode && (deadline > now)) {
+            /* Sleep until the slice is due, rather than polling. */
+            std::this_thread::sleep_until(deadline);
+        } else if (!dopause) {
+            /* Yes, so do one slice now. */
+            if ((now - deadline) > std::chrono::microseconds(PC_SLICE_LATE_US))
+                deadline = now;
+            deadline += std::chrono::microseconds(pc_slice_next());
 
-#ifdef USE_INSTRUMENT
-            uint64_t start_time = elapsed_timer.nsecsElapsed();
-#endif
             /* Run a block of code. */
             pc_run();
 
+            const uint64_t elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(slice_clock::now() - now).count();
+            pc_slice_done(elapsed_us);
+
 #ifdef USE_INSTRUMENT
             if (instru_enabled) {
-                uint64_t elapsed_us       = (elapsed_timer.nsecsElapsed() - start_time) / 1000;
                 uint64_t total_elapsed_ms = (uint64_t) ((double) tsc / cpu_s->rspeed * 1000);
                 printf("[instrument] %llu, %llu\n", total_elapsed_ms, elapsed_us);
                 if (instru_run_ms && total_elapsed_ms >= instru_run_ms)
@@ -110,6 +110,7 @@ extern "C" {
 #        define NOMINMAX
 #    endif
 #    include <windows.h>
+#    include <io.h>
 #    include <86box/win.h>
 #else
 #    include <strings.h>
@@ -396,6 +397,89 @@ plat_munmap(void *ptr, size_t size)
 #endif
 }
 
+void
+plat_mmap_hugepages(void *ptr, size_t size)
+{
+#if defined Q_OS_UNIX && defined MADV_HUGEPAGE
+    /* Only a hint; kernels without transparent huge pages simply refuse it. */
+    madvise(ptr, size, MADV_HUGEPAGE);
+#else
+    /* Windows large pages need SeLockMemoryPrivilege and are never paged
+       out, which is not worth it for guest RAM. */
+    (void) ptr;
+    (void) size;
+#endif
+}
+
+void
+plat_mmap_mergeable(void *ptr, size_t size)
+{
+#if defined Q_OS_UNIX && defined MADV_MERGEABLE
+    madvise(ptr, size, MADV_MERGEABLE);
+#else
+    (void) ptr;
+    (void) size;
+#endif
+}
+
+void *
+plat_mmap_file(FILE *fp, size_t offset, size_t size)
+{
+    /* A copy-on-write mapping shares the page cache with every other
+       process mapping the same file, until a page is written to. */
+#if defined Q_OS_WINDOWS
+    HANDLE file    = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(fp)));
+    HANDLE mapping = CreateFileMapping(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    void  *ret;
+
+    if (mapping == NULL)
+        return nullptr;
+    ret = MapViewOfFile(mapping, FILE_MAP_COPY, static_cast<DWORD>(static_cast<uint64_t>(offset) >> 32),
+                        static_cast<DWORD>(offset), size);
+    /* The view keeps the mapping object alive. */
+    CloseHandle(mapping);
+
+    return ret;
+#else
+    void *ret = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fp), offset);
+
+    return (ret == MAP_FAILED) ? nullptr : ret;
+#endif
+}
+
+size_t
+plat_mresident(void *ptr, size_t size)
+{
+#if defined Q_OS_UNIX
+    size_t        page_size = sysconf(_SC_PAGESIZE);
+    size_t        resident  = 0;
+    unsigned char vec[1024];
+
+    for (size_t offset = 0; offset < size; offset += sizeof(vec) * page_size) {
+        size_t chunk = std::min(size - offset, sizeof(vec) * page_size);
+        size_t nr    = (chunk + page_size - 1) / page_size;
+
+#    if defined Q_OS_LINUX
+        if (mincore(static_cast<uint8_t *>(ptr) + offset, chunk, vec))
+#    else
+        if (mincore(static_cast<char *>(ptr) + offset, chunk, reinterpret_cast<char *>(vec)))
+#    endif
+            return size;
+        for (size_t c = 0; c < nr; c++) {
+            if (vec[c] & 1)
+                resident += page_size;
+        }
+    }
+
+    return std::min(resident, size);
+#else
+    /* VirtualAlloc() commits the whole block up front and there is no cheap
+       residency query, so report the committed size. */
+    (void) ptr;
+    return size;
+#endif
+}
+
 extern bool cpu_thread_running;
 void
 plat_pause(int p)
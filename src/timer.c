@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 #include <86box/86box.h>
@@ -10,81 +11,136 @@
 uint64_t TIMER_USEC;
 uint32_t timer_target;
 
-/*Enabled timers are stored in a linked list, with the first timer to expire at
-  the head.*/
-pc_timer_t *timer_head = NULL;
+/*Enabled timers are stored in a binary min-heap, with the first timer to
+  expire at the root. Timers expiring at the same time are ordered so that the
+  one enabled last goes first.*/
+static pc_timer_t **timer_heap       = NULL;
+static int          timer_heap_count = 0;
+static int          timer_heap_size  = 0;
+static uint32_t     timer_seq        = 0;
 
 /* Are we initialized? */
 int timer_inited = 0;
 
 static void timer_advance_ex(pc_timer_t *timer, int start);
 
+/*True if timer a has to be run before timer b*/
+static __inline int
+timer_heap_before(const pc_timer_t *a, const pc_timer_t *b)
+{
+    int64_t diff = (int64_t) (a->ts.ts64 - b->ts.ts64);
+
+    if (diff)
+        return diff < 0;
+
+    return (int32_t) (a->seq - b->seq) > 0;
+}
+
+static __inline void
+timer_heap_put(pc_timer_t *timer, int pos)
+{
+    timer_heap[pos] = timer;
+    timer->heap_pos = pos;
+}
+
+static void
+timer_heap_sift_up(int pos)
+{
+    pc_timer_t *timer = timer_heap[pos];
+
+    while (pos > 0) {
+        int parent = (pos - 1) >> 1;
+
+        if (!timer_heap_before(timer, timer_heap[parent]))
+            break;
+
+        timer_heap_put(timer_heap[parent], pos);
+        pos = parent;
+    }
+
+    timer_heap_put(timer, pos);
+}
+
+static void
+timer_heap_sift_down(int pos)
+{
+    pc_timer_t *timer = timer_heap[pos];
+
+    while (1) {
+        int child = (pos << 1) + 1;
+
+        if (child >= timer_heap_count)
+            break;
+        if (((child + 1) < timer_heap_count) && timer_heap_before(timer_heap[child + 1], timer_heap[child]))
+            child++;
+        if (!timer_heap_before(timer_heap[child], timer))
+            break;
+
+        timer_heap_put(timer_heap[child], pos);
+        pos = child;
+    }
+
+    timer_heap_put(timer, pos);
+}
+
+/*Restore the heap order after the timestamp of the timer at pos changed*/
+static void
+timer_heap_fix(int pos)
+{
+    if ((pos > 0) && timer_heap_before(timer_heap[pos], timer_heap[(pos - 1) >> 1]))
+        timer_heap_sift_up(pos);
+    else
+        timer_heap_sift_down(pos);
+}
+
+static void
+timer_heap_remove(int pos)
+{
+    pc_timer_t *last = timer_heap[--timer_heap_count];
+
+    if (pos < timer_heap_count) {
+        timer_heap_put(last, pos);
+        timer_heap_fix(pos);
+    }
+}
+
+static __inline void
+timer_update_target(void)
+{
+    if (timer_heap_count)
+        timer_target = timer_heap[0]->ts.ts32.integer;
+}
+
 void
 timer_enable(pc_timer_t *timer)
 {
-    pc_timer_t *timer_node = timer_head;
-    int ret = 0;
-
     if (!timer_inited || (timer == NULL))
         return;
 
-    if (timer->flags & TIMER_ENABLED)
-        timer_disable(timer);
-
-    if (timer->next || timer->prev)
-        fatal("timer_disable(): Attempting to enable a non-isolated "
-              "timer incorrectly marked as disabled\n");
-
-    /*List currently empty - add to head*/
-    if (!timer_head) {
-        timer_head  = timer;
-        timer->next = timer->prev = NULL;
-        timer_target              = timer_head->ts.ts32.integer;
-        ret = 1;
-    } else if (TIMER_LESS_THAN(timer, timer_head)) {
-        timer->next      = timer_head;
-        timer->prev      = NULL;
-        timer_head->prev = timer;
-        timer_head       = timer;
-        timer_target     = timer_head->ts.ts32.integer;
-        ret = 1;
-    } else if (!timer_head->next) {
-        timer_head->next = timer;
-        timer->prev      = timer_head;
-        ret = 1;
-    }
+    timer->seq = ++timer_seq;
 
-    if (ret == 0) {
-        pc_timer_t *prev = timer_head;
-        timer_node       = timer_head->next;
-
-        while (1) {
-            /*Timer expires before timer_node. Add to list in front of timer_node*/
-            if (TIMER_LESS_THAN(timer, timer_node)) {
-                timer->next      = timer_node;
-                timer->prev      = prev;
-                timer_node->prev = timer;
-                prev->next       = timer;
-                ret = 1;
-                break;
-            }
-
-            /*timer_node is last in the list. Add timer to end of list*/
-            if (!timer_node->next) {
-                timer_node->next = timer;
-                timer->prev      = timer_node;
-                ret = 1;
-                break;
-            }
-
-            prev       = timer_node;
-            timer_node = timer_node->next;
+    if (timer->flags & TIMER_ENABLED) {
+        /*Already queued - the timestamp may have changed, so just move it*/
+        if ((timer->heap_pos >= timer_heap_count) || (timer_heap[timer->heap_pos] != timer))
+            fatal("timer_enable(): Enabled timer is not in the timer heap\n");
+
+        timer->in_callback = 0;
+        timer_heap_fix(timer->heap_pos);
+    } else {
+        if (timer_heap_count == timer_heap_size) {
+            timer_heap_size = timer_heap_size ? (timer_heap_size << 1) : 64;
+            timer_heap      = (pc_timer_t **) realloc(timer_heap, timer_heap_size * sizeof(pc_timer_t *));
+            if (timer_heap == NULL)
+                fatal("timer_enable(): Out of memory\n");
         }
-    }
 
-    /* Do not mark it as enabled if it has failed every single condition. */
-    if (ret == 1)
+        timer_heap_put(timer, timer_heap_count++);
+        timer_heap_sift_up(timer->heap_pos);
+
         timer->flags |= TIMER_ENABLED;
+    }
+
+    timer_update_target();
 }
 
 void
@@ -93,20 +149,21 @@ timer_disable(pc_timer_t *timer)
     if (!timer_inited || (timer == NULL) || !(timer->flags & TIMER_ENABLED))
         return;
 
-    if (!timer->next && !timer->prev && timer != timer_head)
-        fatal("timer_disable(): Attempting to disable an isolated "
-              "non-head timer incorrectly marked as enabled\n");
+    if ((timer->heap_pos >= timer_heap_count) || (timer_heap[timer->heap_pos] != timer))
+        fatal("timer_disable(): Attempting to disable a timer "
+              "incorrectly marked as enabled\n");
 
     timer->flags &= ~TIMER_ENABLED;
     timer->in_callback = 0;
 
-    if (timer->prev)
-        timer->prev->next = timer->next;
-    else
-        timer_head = timer->next;
-    if (timer->next)
-        timer->next->prev = timer->prev;
-    timer->prev = timer->next = NULL;
+    timer_heap_remove(timer->heap_pos);
+    timer_update_target();
+}
+
+int
+timer_pending(void)
+{
+    return timer_heap_count != 0;
 }
 
 void
@@ -114,20 +171,16 @@ timer_process(void)
 {
     pc_timer_t *timer;
 
-    if (!timer_head)
+    if (!timer_heap_count)
         return;
 
-    while (1) {
-        timer = timer_head;
+    while (timer_heap_count) {
+        timer = timer_heap[0];
 
         if (!TIMER_LESS_THAN_VAL(timer, (uint32_t) tsc))
             break;
 
-        timer_head = timer->next;
-        if (timer_head)
-            timer_head->prev = NULL;
-
-        timer->next = timer->prev = NULL;
+        timer_heap_remove(0);
         timer->flags &= ~TIMER_ENABLED;
 
         if (timer->flags & TIMER_SPLIT)
@@ -143,25 +196,18 @@ timer_process(void)
         }
     }
 
-    timer_target = timer_head->ts.ts32.integer;
+    timer_update_target();
 }
 
 void
 timer_close(void)
 {
-    pc_timer_t *t = timer_head;
-    pc_timer_t *r;
-
-    /* Set all timers' prev and next to NULL so it is assured that
-       timers that are not in malloc'd structs don't keep pointing
-       to timers that may be in malloc'd structs. */
-    while (t != NULL) {
-        r       = t;
-        r->prev = r->next = NULL;
-        t                 = r->next;
-    }
+    /* Timers live in device structs that are about to be freed, so
+       just forget about the queued ones. */
+    for (int i = 0; i < timer_heap_count; i++)
+        timer_heap[i]->flags &= ~TIMER_ENABLED;
 
-    timer_head = NULL;
+    timer_heap_count = 0;
 
     timer_inited = 0;
 }
@@ -187,7 +233,6 @@ timer_add(pc_timer_t *timer, void (*callback)(void *priv), void *priv, int start
     timer->in_callback = 0;
     timer->priv        = priv;
     timer->flags       = 0;
-    timer->prev        = timer->next = NULL;
     if (start_timer)
         timer_set_delay_u64(timer, 0);
 }
@@ -264,27 +309,26 @@ timer_on_auto(pc_timer_t *timer, double period)
 void
 timer_set_new_tsc(uint64_t new_tsc)
 {
-    pc_timer_t *timer = NULL;
     /* Run timers already expired. */
 #ifdef USE_DYNAREC
     if (cpu_use_dynarec)
         update_tsc();
 #endif
 
-    if (!timer_head) {
+    if (!timer_heap_count) {
         tsc = new_tsc;
         return;
     }
 
-    timer = timer_head;
-    timer_target = new_tsc + (int32_t)(timer_get_ts_int(timer_head) - (uint32_t)tsc);
+    /* Every timer moves by the same amount, so the heap order is kept. */
+    for (int i = 0; i < timer_heap_count; i++) {
+        pc_timer_t *timer                   = timer_heap[i];
+        int32_t     offset_from_current_tsc = (int32_t) (timer_get_ts_int(timer) - (uint32_t) tsc);
 
-    while (timer) {
-        int32_t offset_from_current_tsc = (int32_t)(timer_get_ts_int(timer) - (uint32_t)tsc);
         timer->ts.ts32.integer = new_tsc + offset_from_current_tsc;
-
-        timer = timer->next;
     }
 
+    timer_update_target();
+
     tsc = new_tsc;
 }
@@ -0,0 +1,144 @@
+/*
+ * 86Box    A hypervisor and IBM PC system emulator that specializes in
+ *          running old operating systems and software designed for IBM
+ *          PC systems and compatibles from 1981 through fairly recent
+ *          system designs based on the PCI bus.
+ *
+ *          This file is part of the 86Box distribution.
+ *
+ *          Timer queue microbenchmark.
+ *
+ *          Drives timer_process() the way the CPU loop does, with a
+ *          configurable number of periodic timers that also re-arm other
+ *          timers from their callbacks, and reports the time taken and
+ *          any timer that was run before its deadline.
+ *
+ *          Usage: timer_bench [timers [cycles]]
+ *
+ *          Built with -DTIMER_BENCH=ON.
+ *
+ * Authors: agent, <agent@local>
+ *
+ *          Copyright 2026 agent.
+ */
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <86box/timer.h>
+
+#define TIMERS_DEFAULT 500
+#define CYCLES_DEFAULT 20000000ULL
+/* Cycles run between two checks of timer_target, as by a short block. */
+#define CYCLES_STEP    50
+
+uint64_t tsc;
+#ifdef USE_DYNAREC
+int cpu_use_dynarec;
+#endif
+
+static pc_timer_t *timers;
+static uint64_t   *periods;
+static int         nr_timers;
+static uint64_t    callbacks;
+static uint64_t    early;
+
+/* Stubs for what timer.c pulls in from the rest of the emulator. */
+void
+fatal(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    exit(1);
+}
+
+void
+rivatimer_init(void)
+{
+    /* No rivatimers here. */
+}
+
+#ifdef USE_DYNAREC
+void
+update_tsc(void)
+{
+    /* tsc is always current here. */
+}
+#endif
+
+static void
+bench_callback(void *priv)
+{
+    int i = (int) (intptr_t) priv;
+    int j;
+
+    callbacks++;
+    if ((int32_t) (timers[i].ts.ts32.integer - (uint32_t) tsc) > 0)
+        early++;
+
+    timer_advance_u64(&timers[i], periods[i]);
+
+    /* Every seventh timer also moves another one, as devices reprogramming
+       each other do. */
+    if (!(i % 7)) {
+        j = (i * 13) % nr_timers;
+        timer_disable(&timers[j]);
+        timer_set_delay_u64(&timers[j], periods[j]);
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    uint64_t        nr_cycles = CYCLES_DEFAULT;
+    uint64_t        checks    = 0;
+    struct timespec start;
+    struct timespec end;
+    double          secs;
+
+    nr_timers = (argc > 1) ? atoi(argv[1]) : TIMERS_DEFAULT;
+    if (argc > 2)
+        nr_cycles = strtoull(argv[2], NULL, 0);
+    if (nr_timers < 1) {
+        fprintf(stderr, "Usage: %s [timers [cycles]]\n", argv[0]);
+        return 1;
+    }
+
+    timers  = calloc(nr_timers, sizeof(pc_timer_t));
+    periods = calloc(nr_timers, sizeof(uint64_t));
+
+    timer_init();
+    TIMER_USEC = 1ULL << 32;
+
+    /* Fixed seed, so that runs can be compared. */
+    srand(1);
+    for (int i = 0; i < nr_timers; i++) {
+        periods[i] = ((uint64_t) (1 + (rand() % 5000))) << 32;
+        timer_add(&timers[i], bench_callback, (void *) (intptr_t) i, 0);
+        timer_set_delay_u64(&timers[i], periods[i]);
+    }
+
+    timespec_get(&start, TIME_UTC);
+    for (uint64_t c = 0; c < nr_cycles; c += CYCLES_STEP) {
+        tsc = c;
+        if (TIMER_VAL_LESS_THAN_VAL(timer_target, (uint32_t) tsc))
+            timer_process();
+        checks++;
+    }
+    timespec_get(&end, TIME_UTC);
+
+    secs = (double) (end.tv_sec - start.tv_sec) + ((double) (end.tv_nsec - start.tv_nsec) / 1000000000.0);
+    printf("%i timers, %" PRIu64 " cycles: %" PRIu64 " callbacks, %" PRIu64 " run early, %.3f s (%.1f ns per callback)\n",
+           nr_timers, nr_cycles, callbacks, early, secs, callbacks ? ((secs * 1000000000.0) / (double) callbacks) : 0.0);
+
+    timer_close();
+    free(periods);
+    free(timers);
+
+    return early ? 1 : 0;
+}
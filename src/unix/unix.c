@@ -424,6 +424,55 @@ plat_munmap(void *ptr, size_t size)
     munmap(ptr, size);
 }
 
+void
+plat_mmap_hugepages(void *ptr, size_t size)
+{
+#ifdef MADV_HUGEPAGE
+    /* Only a hint; kernels without transparent huge pages simply refuse it. */
+    madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+}
+
+void
+plat_mmap_mergeable(void *ptr, size_t size)
+{
+#ifdef MADV_MERGEABLE
+    madvise(ptr, size, MADV_MERGEABLE);
+#endif
+}
+
+void *
+plat_mmap_file(FILE *fp, size_t offset, size_t size)
+{
+    /* A private writable mapping shares the page cache with every other
+       process mapping the same file, until a page is written to. */
+    void *ret = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(fp), offset);
+
+    return (ret == MAP_FAILED) ? NULL : ret;
+}
+
+size_t
+plat_mresident(void *ptr, size_t size)
+{
+    size_t        page_size = sysconf(_SC_PAGESIZE);
+    size_t        resident  = 0;
+    unsigned char vec[1024];
+
+    for (size_t offset = 0; offset < size; offset += sizeof(vec) * page_size) {
+        size_t chunk = MIN(size - offset, sizeof(vec) * page_size);
+        size_t nr    = (chunk + page_size - 1) / page_size;
+
+        if (mincore((uint8_t *) ptr + offset, chunk, (void *) vec))
+            return size;
+        for (size_t c = 0; c < nr; c++) {
+            if (vec[c] & 1)
+                resident += page_size;
+        }
+    }
+
+    return MIN(resident, size);
+}
+
 uint64_t
 plat_timer_read(void)
 {
@@ -540,37 +589,71 @@ strnicmp(const char *s1, const char *s2, size_t n)
     return strncasecmp(s1, s2, n);
 }
 
+/* Monotonic host time, in microseconds. */
+static uint64_t
+main_thread_time_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t) ts.tv_sec * 1000000ULL) + (ts.tv_nsec / 1000);
+}
+
+/* Sleep until an absolute time, so that wakeups do not drift. */
+static void
+main_thread_sleep_until(uint64_t deadline)
+{
+#if defined(__APPLE__) || defined(__HAIKU__)
+    uint64_t        now = main_thread_time_us();
+    struct timespec ts;
+
+    if (deadline <= now)
+        return;
+
+    ts.tv_sec  = (deadline - now) / 1000000;
+    ts.tv_nsec = ((deadline - now) % 1000000) * 1000;
+    nanosleep(&ts, NULL);
+#else
+    struct timespec ts;
+
+    ts.tv_sec  = deadline / 1000000;
+    ts.tv_nsec = (deadline % 1000000) * 1000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+#endif
+}
+
 void
 main_thread(UNUSED(void *param))
 {
-    uint32_t old_time;
-    uint32_t new_time;
-    int      drawits;
+    uint64_t deadline;
+    uint64_t now;
     int      frames;
 
     SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
     framecountx = 0;
     // title_update = 1;
-    old_time = SDL_GetTicks();
-    drawits = frames = 0;
+    deadline = main_thread_time_us();
+    frames   = 0;
     while (!is_quit && cpu_thread_run) {
-        /* See if it is time to run a frame of code. */
-        new_time = SDL_GetTicks();
+        /* See if it is time to run a slice of code. */
+        now = main_thread_time_us();
 #ifdef USE_GDBSTUB
-        if (gdbstub_next_asap && (drawits <= 0))
-            drawits = 10;
-        else
+        if (gdbstub_next_asap && (deadline > now))
+            deadline = now;
 #endif
-            drawits += (new_time - old_time);
-        old_time = new_time;
-        if (drawits > 0 && !dopause) {
-            /* Yes, so do one frame now. */
-            drawits -= 10;
-            if (drawits > 50)
-                drawits = 0;
+        if (!dopause && !turbo_mode && (deadline > now))
+            main_thread_sleep_until(deadline);
+        else if (!dopause) {
+            /* Yes, so do one slice now. */
+            if ((now - deadline) > PC_SLICE_LATE_US)
+                deadline = now;
+            deadline += pc_slice_next();
 
             /* Run a block of code. */
             pc_run();
+            pc_slice_done(main_thread_time_us() - now);
 
             /* Every 200 frames we save the machine status. */
             if (++frames >= 200 && nvr_dosave) {
@@ -983,6 +1066,10 @@ monitor_thread(UNUSED(void *param))
                         "hardreset - hard reset the emulated system.\n"
                         "pause - pause the the emulated system.\n"
                         "fullscreen - toggle fullscreen.\n"
+                        "meminfo - print host memory used by the emulated RAM.\n"
+                        "memscan - count the emulated RAM pages that could be shared.\n"
+                        "slice - print the main loop slice length and host time per slice.\n"
+                        "turbo [on|off] - run as fast as the host allows, or return to real time.\n"
                         "version - print version and license information.\n"
                         "exit - exit 86Box.\n");
                 } else if (strncasecmp(xargv[0], "exit", 4) == 0) {
@@ -1026,6 +1113,32 @@ monitor_thread(UNUSED(void *param))
                 } else if (strncasecmp(xargv[0], "fullscreen", 10) == 0) {
                     video_fullscreen   = video_fullscreen ? 0 : 1;
                     fullscreen_pending = 1;
+                } else if (strncasecmp(xargv[0], "meminfo", 7) == 0) {
+                    mem_usage_t usage;
+
+                    mem_get_usage(&usage);
+                    printf("RAM: %" PRIu64 " of %" PRIu64 " KB resident\n"
+                           "Page tables and dirty masks: %" PRIu64 " of %" PRIu64 " KB resident\n",
+                           usage.ram_resident >> 10, usage.ram_size >> 10,
+                           usage.meta_resident >> 10, usage.meta_size >> 10);
+                } else if (strncasecmp(xargv[0], "memscan", 7) == 0) {
+                    mem_dedup_t dedup;
+
+                    mem_dedup_scan(&dedup);
+                    printf("%u pages: %u zero, %u unique, %u duplicates\n",
+                           dedup.pages, dedup.zero_pages, dedup.unique_pages, dedup.dup_pages);
+                } else if (strncasecmp(xargv[0], "slice", 5) == 0) {
+                    int      slice_us = pc_slice_us;
+                    uint64_t host_us  = pc_slice_host_us;
+
+                    printf("Slice: %i us, last one took %" PRIu64 " us of host time (%i%%)\n",
+                           slice_us, host_us, (int) ((host_us * 100) / slice_us));
+                } else if (strncasecmp(xargv[0], "turbo", 5) == 0) {
+                    if (cmdargc >= 2)
+                        turbo_mode = !strncasecmp(xargv[1], "on", 2);
+                    else
+                        turbo_mode ^= 1;
+                    printf("%s", turbo_mode ? "Turbo mode on.\n" : "Turbo mode off.\n");
                 } else if (strncasecmp(xargv[0], "pause", 5) == 0) {
                     plat_pause(dopause ^ 1);
                     printf("%s", dopause ? "Paused.\n" : "Unpaused.\n");
@@ -30,18 +30,57 @@ LARGE_INTEGER performance_frequency;
 
 rivatimer_t* rivatimer_head;        // The head of the rivatimer list. 
 rivatimer_t* rivatimer_tail;        // The tail of the rivatimer list.
+rivatimer_t* rivatimer_queue;       // The running rivatimer with the earliest deadline.
+
+double rivatimer_emulated_time;     // The emulated clock in uS, only used if rivatimer_emulated is set.
 
 /* Functions only used in this translation unit */
 bool rivatimer_really_exists(rivatimer_t* rivatimer);   // Determine if a rivatimer really exists in the linked list.
 
+// Removes a running rivatimer from the deadline queue.
+static void rivatimer_queue_remove(rivatimer_t* rivatimer_ptr)
+{
+    if (rivatimer_ptr->queue_prev)
+        rivatimer_ptr->queue_prev->queue_next = rivatimer_ptr->queue_next;
+    else
+        rivatimer_queue = rivatimer_ptr->queue_next;
+
+    if (rivatimer_ptr->queue_next)
+        rivatimer_ptr->queue_next->queue_prev = rivatimer_ptr->queue_prev;
+
+    rivatimer_ptr->queue_prev = NULL;
+    rivatimer_ptr->queue_next = NULL;
+}
+
+// Inserts a running rivatimer into the deadline queue, after any timers due at the same time.
+static void rivatimer_queue_insert(rivatimer_t* rivatimer_ptr)
+{
+    rivatimer_t* prev = NULL;
+    rivatimer_t* current = rivatimer_queue;
+
+    while (current && current->deadline <= rivatimer_ptr->deadline)
+    {
+        prev = current;
+        current = current->queue_next;
+    }
+
+    rivatimer_ptr->queue_prev = prev;
+    rivatimer_ptr->queue_next = current;
+
+    if (prev)
+        prev->queue_next = rivatimer_ptr;
+    else
+        rivatimer_queue = rivatimer_ptr;
+
+    if (current)
+        current->queue_prev = rivatimer_ptr;
+}
+
 void rivatimer_init(void)
 {
     // Destroy all the rivatimers.
     rivatimer_t* rivatimer_ptr = rivatimer_head;
 
-    if (!rivatimer_ptr)
-        return;
-
     while (rivatimer_ptr)
     {
         // since we are destroing it
@@ -50,7 +89,8 @@ void rivatimer_init(void)
         
         rivatimer_ptr = old_next;
     }
-        
+
+    rivatimer_emulated_time = 0;
 
     #ifdef _WIN32
     // Query the performance frequency.
@@ -58,6 +98,35 @@ void rivatimer_init(void)
     #endif
 }
 
+// Gets the current rivatimer clock in microseconds.
+// This is the host's monotonic clock, or the emulated clock if rivatimer_emulated is set.
+double rivatimer_get_clock(void)
+{
+    if (rivatimer_emulated)
+        return rivatimer_emulated_time;
+
+    #ifdef _WIN32
+        LARGE_INTEGER current_time;
+
+        QueryPerformanceCounter(&current_time);
+
+        return ((double)current_time.QuadPart * 1000000.0) / (double)performance_frequency.QuadPart;
+    #else
+        struct timespec current_time;
+
+        clock_gettime(CLOCK_MONOTONIC, &current_time);
+
+        return ((double)current_time.tv_sec * 1000000.0) + ((double)current_time.tv_nsec / 1000.0);
+    #endif
+}
+
+// Advances the emulated clock. Called by the main loop with the length of each CPU slice it runs.
+void rivatimer_advance(double microseconds)
+{
+    if (rivatimer_emulated)
+        rivatimer_emulated_time += microseconds;
+}
+
 // Creates a rivatimer.
 rivatimer_t* rivatimer_create(double period, void (*callback)(double real_time))
 {
@@ -81,6 +150,7 @@ rivatimer_t* rivatimer_create(double period, void (*callback)(double real_time))
     else // Otherwise add a new one to the list
     {
         rivatimer_tail->next = calloc(1, sizeof(rivatimer_t));
+        rivatimer_tail->next->prev = rivatimer_tail;
         rivatimer_tail = rivatimer_tail->next;
         new_rivatimer = rivatimer_tail;
     }
@@ -121,6 +191,9 @@ void rivatimer_destroy(rivatimer_t* rivatimer_ptr)
 {
     if (!rivatimer_really_exists(rivatimer_ptr))
         fatal("rivatimer_destroy: The timer was already destroyed, or never existed in the first place.");
+
+    if (rivatimer_ptr->running)
+        rivatimer_queue_remove(rivatimer_ptr);
     
     // Case: We are destroying the head
     if (rivatimer_ptr == rivatimer_head)
@@ -152,70 +225,65 @@ void rivatimer_destroy(rivatimer_t* rivatimer_ptr)
     else
     {
         // Fix the break in the chain that this 
-        if (rivatimer_ptr->next)
-            rivatimer_ptr->prev->next = rivatimer_ptr->next;
-        if (rivatimer_ptr->prev)
-            rivatimer_ptr->next->prev = rivatimer_ptr->prev;
+        rivatimer_ptr->prev->next = rivatimer_ptr->next;
+        rivatimer_ptr->next->prev = rivatimer_ptr->prev;
     }
 
     free(rivatimer_ptr);
     rivatimer_ptr = NULL; //explicitly set to null
 }
 
+// Fires every rivatimer whose deadline has passed. Only the front of the deadline queue is looked at, and the clock is only read once.
 void rivatimer_update_all(void)
 {
-    rivatimer_t* rivatimer_ptr = rivatimer_head;
+    rivatimer_t* rivatimer_ptr;
+    double current_time;
+    double microseconds;
 
-    if (!rivatimer_ptr)
+    if (!rivatimer_queue)
         return;
 
-    while (rivatimer_ptr)
+    current_time = rivatimer_get_clock();
+
+    while ((rivatimer_ptr = rivatimer_queue) && rivatimer_ptr->deadline <= current_time)
     {
-        // if it's not running skip it
-        if (!rivatimer_ptr->running)
-        {
-            rivatimer_ptr = rivatimer_ptr->next;
-            continue;
-        }
+        microseconds = current_time - rivatimer_ptr->starting_time;
 
-        #ifdef _WIN32
-            LARGE_INTEGER current_time;
+        rivatimer_ptr->time += microseconds;
+        rivatimer_ptr->starting_time = current_time;
 
-            QueryPerformanceCounter(&current_time);
+        // Schedule the next firing. If we fell more than a period behind, the callback gets the whole elapsed time in one go
+        // rather than being called once for every period that was missed.
+        rivatimer_ptr->deadline += rivatimer_ptr->period;
 
-            double microseconds = ((double)current_time.QuadPart / 1000000.0) - (rivatimer_ptr->starting_time.QuadPart / 1000000.0);
-        #else
-            struct timespec current_time; 
+        if (rivatimer_ptr->deadline <= current_time)
+            rivatimer_ptr->deadline = current_time + rivatimer_ptr->period;
 
-            clock_gettime(CLOCK_REALTIME, &current_time);
+        // Requeue before calling back, since the callback may stop, restart or destroy the timer.
+        rivatimer_queue_remove(rivatimer_ptr);
+        rivatimer_queue_insert(rivatimer_ptr);
 
-            double microseconds = ((double)current_time.tv_sec * 1000000.0) + ((double)current_time.tv_nsec / 1000.0);
-        #endif
+        rivatimer_ptr->callback(microseconds);
+    }
+}
 
-        rivatimer_ptr->time += microseconds; 
+// Returns the time in uS until the next rivatimer is due to fire, 0 if one is already due, or < 0 if none are running.
+// Timers with a period shorter than RIVATIMER_SLICE_MIN_US are left out. They would be due at every single check, so splitting 
+// the CPU slice for them would only multiply the work; they are serviced once per slice instead.
+double rivatimer_next_deadline(void)
+{
+    rivatimer_t* rivatimer_ptr = rivatimer_queue;
+    double remaining;
 
-        // Reset the current time so we can actually restart
-        #ifdef _WIN32
-            QueryPerformanceCounter(&rivatimer_ptr->starting_time);
-        #else
-            clock_gettime(CLOCK_REALTIME, &rivatimer_ptr->starting_time);
-        #endif 
+    while (rivatimer_ptr && rivatimer_ptr->period < RIVATIMER_SLICE_MIN_US)
+        rivatimer_ptr = rivatimer_ptr->queue_next;
 
-        // Time to fire
-        if (microseconds > rivatimer_ptr->period)
-        {
-            if (!rivatimer_ptr->callback)
-            {
-                pclog("Eh? No callback in RivaTimer?");
-                continue;
-            }
-                    
-            rivatimer_ptr->callback(microseconds);
-        }
+    if (!rivatimer_ptr)
+        return -1.0;
 
-        rivatimer_ptr = rivatimer_ptr->next;
-    }
+    remaining = rivatimer_ptr->deadline - rivatimer_get_clock();
 
+    return (remaining > 0) ? remaining : 0;
 }
 
 void rivatimer_start(rivatimer_t* rivatimer_ptr)
@@ -226,14 +294,16 @@ void rivatimer_start(rivatimer_t* rivatimer_ptr)
     if (rivatimer_ptr->period <= 0)
         fatal("rivatimer_start: Zero period!");
 
+    if (rivatimer_ptr->running)
+        rivatimer_queue_remove(rivatimer_ptr);
+
     rivatimer_ptr->running = true;
 
     // Start off so rivatimer_update_all can actually update.
-    #ifdef _WIN32
-        QueryPerformanceCounter(&rivatimer_ptr->starting_time);
-    #else
-        clock_gettime(CLOCK_REALTIME, &rivatimer_ptr->starting_time);
-    #endif 
+    rivatimer_ptr->starting_time = rivatimer_get_clock();
+    rivatimer_ptr->deadline = rivatimer_ptr->starting_time + rivatimer_ptr->period;
+
+    rivatimer_queue_insert(rivatimer_ptr);
 }
 
 void rivatimer_stop(rivatimer_t* rivatimer_ptr)
@@ -241,6 +311,9 @@ void rivatimer_stop(rivatimer_t* rivatimer_ptr)
     if (!rivatimer_really_exists(rivatimer_ptr))
         fatal("rivatimer_stop: The timer has been destroyed, or never existed in the first place.");
 
+    if (rivatimer_ptr->running)
+        rivatimer_queue_remove(rivatimer_ptr);
+
     rivatimer_ptr->running = false;
     rivatimer_ptr->time = 0;
 }
@@ -270,5 +343,16 @@ void rivatimer_set_period(rivatimer_t* rivatimer_ptr, double period)
     if (!rivatimer_really_exists(rivatimer_ptr))
        fatal("rivatimer_set_period: The timer has been destroyed, or never existed in the first place.");
 
+    if (period <= 0)
+        fatal("rivatimer_set_period: Zero period!");
+
     rivatimer_ptr->period = period;
-}
\ No newline at end of file
+
+    // Move the pending deadline so the new period applies from the last firing.
+    if (rivatimer_ptr->running)
+    {
+        rivatimer_ptr->deadline = rivatimer_ptr->starting_time + period;
+        rivatimer_queue_remove(rivatimer_ptr);
+        rivatimer_queue_insert(rivatimer_ptr);
+    }
+}
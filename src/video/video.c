@@ -463,11 +463,23 @@ blit_thread(void *param)
 void
 video_blit_memtoscreen_monitor(int x, int y, int w, int h, int monitor_index)
 {
+    static uint32_t turbo_blit_ticks[MONITORS_NUM];
+
     MTR_BEGIN("video", "video_blit_memtoscreen");
 
     if ((w <= 0) || (h <= 0))
         return;
 
+    /* In turbo mode the guest produces frames far faster than they
+       can be shown, so only present them at a capped rate. */
+    if (turbo_mode) {
+        uint32_t ticks = plat_get_ticks();
+
+        if ((ticks - turbo_blit_ticks[monitor_index]) < (1000 / TURBO_FPS))
+            return;
+        turbo_blit_ticks[monitor_index] = ticks;
+    }
+
     video_wait_for_blit_monitor(monitor_index);
 
     monitors[monitor_index].mon_blit_data_ptr->busy          = 1;